@@ -1,6 +1,10 @@
 #include <string.h>
 #include <stdio.h>
+#include <algorithm>
+#include <thread>
+#include <mutex>
 #include "cube3x3.h"
+#include "cube3x3cache.h"
 
 #define FACE_START(face) ((face) * 9)
 #define FACE_OFFSET(row, col) (((row) * 3) + (col))
@@ -9,13 +13,73 @@
 #define ROW_FOR_IDX(i) (((i) / 3) % 3)
 #define COL_FOR_IDX(i) ((i) % 3)
 
+// Parallel searches share the best solution as a single integer containing the solution length
+// and the search order of the subtree it was found in. Lower values are better solutions.
+#define PARALLEL_SEARCH_ORDER_COUNT 4096
+#define PARALLEL_SEARCH_MIN_DEPTH 3
+
+// Number of search nodes between checks of the limits for anytime solves
+#define SEARCH_LIMIT_CHECK_INTERVAL 1024
+
+// Time to spend looking for shorter random state scrambles
+#define RANDOM_STATE_SCRAMBLE_TIME_LIMIT_MS 1000
+
+// Solve statistics are only collected when enabled at build time, so that they have no cost otherwise
+#ifdef CUBE3X3_SOLVE_STATS
+#define SOLVE_STAT(moves, stat) ((moves).stats.stat++)
+#define SOLVE_STAT_TIMER(moves, stat) SolveStatTimer stat##Timer((moves).stats.stat, nullptr)
+#define SOLVE_STAT_NESTED_TIMER(moves, stat, parent) SolveStatTimer stat##Timer((moves).stats.stat, &(moves).stats.parent)
+#else
+#define SOLVE_STAT(moves, stat)
+#define SOLVE_STAT_TIMER(moves, stat)
+#define SOLVE_STAT_NESTED_TIMER(moves, stat, parent)
+#endif
+
 using namespace std;
 
 
+// Limit state shared by all search threads of an anytime solve
+struct Cube3x3SearchLimitState
+{
+	const Cube3x3SolveLimits& limits;
+	atomic<uint64_t> nodeCount;
+	atomic<bool> solutionFound;
+	atomic<bool> stopped;
+	mutex improvedMutex;
+	size_t reportedMoveCount;
+
+	Cube3x3SearchLimitState(const Cube3x3SolveLimits& l): limits(l), nodeCount(0), solutionFound(false),
+		stopped(false), reportedMoveCount(MAX_3X3_SOLUTION_MOVES + 1) {}
+};
+
+
+#ifdef CUBE3X3_SOLVE_STATS
+// Adds the time spent in the current scope to a solve statistic. If a parent is given, the time
+// is removed from it, so that time spent in phase 2 is not also counted as phase 1 time.
+class SolveStatTimer
+{
+	chrono::steady_clock::duration& m_total;
+	chrono::steady_clock::duration* m_parent;
+	chrono::steady_clock::time_point m_start;
+
+public:
+	SolveStatTimer(chrono::steady_clock::duration& total, chrono::steady_clock::duration* parent):
+		m_total(total), m_parent(parent), m_start(chrono::steady_clock::now()) {}
+	~SolveStatTimer()
+	{
+		chrono::steady_clock::duration elapsed = chrono::steady_clock::now() - m_start;
+		m_total += elapsed;
+		if (m_parent)
+			*m_parent -= elapsed;
+	}
+};
+#endif
+
+
 // Table for rotating the corners in piece format. Rotations are organized by
 // the face being rotated. Each entry is where the piece comes from and the
 // adjustment to the orientation (corner twist).
-CubePiece Cube3x3::m_cornerRotation[2][6][8] = {
+constexpr CubePiece Cube3x3::m_cornerRotation[2][6][8] = {
 	// CW
 	{
 		// Top
@@ -111,7 +175,7 @@ CubePiece Cube3x3::m_cornerRotation[2][6][8] = {
 // Table for rotating the edges in piece format. Rotations are organized by
 // the face being rotated. Each entry is where the piece comes from and the
 // adjustment to the orientation (edge flip).
-CubePiece Cube3x3::m_edgeRotation[2][6][12] = {
+constexpr CubePiece Cube3x3::m_edgeRotation[2][6][12] = {
 	// CW
 	{
 		// Top
@@ -192,7 +256,7 @@ CubePiece Cube3x3::m_edgeRotation[2][6][12] = {
 	}
 };
 
-CubeColor Cube3x3::m_cornerColors[8][3] = {
+constexpr CubeColor Cube3x3::m_cornerColors[8][3] = {
 	{WHITE, RED, GREEN}, // URF
 	{WHITE, GREEN, ORANGE}, // UFL
 	{WHITE, ORANGE, BLUE}, // ULB
@@ -203,7 +267,7 @@ CubeColor Cube3x3::m_cornerColors[8][3] = {
 	{YELLOW, RED, BLUE} // DRB
 };
 
-CubeColor Cube3x3::m_edgeColors[12][2] = {
+constexpr CubeColor Cube3x3::m_edgeColors[12][2] = {
 	{WHITE, RED}, // UR
 	{WHITE, GREEN}, // UF
 	{WHITE, ORANGE}, // UL
@@ -218,6 +282,61 @@ CubeColor Cube3x3::m_edgeColors[12][2] = {
 	{BLUE, RED} // BR
 };
 
+constexpr Cube3x3::FaceConversionTables Cube3x3::GetFaceConversionTables()
+{
+	// Colors that are not a valid piece convert to the first piece
+	FaceConversionTables result = {};
+	for (uint8_t i = 0; i < 8; i++)
+	{
+		for (uint8_t j = 0; j < 3; j++)
+		{
+			// Orientation is the number of clockwise twists of the piece's colors
+			CubeColor colors[3] = {};
+			for (int k = 0; k < 3; k++)
+			{
+				colors[k] = m_cornerColors[i][(k + 3 - j) % 3];
+				result.cornerColors[i][j][k] = colors[k];
+			}
+			result.cornerPieces[(colors[0] * 36) + (colors[1] * 6) + colors[2]] = CubePiece { i, j };
+		}
+	}
+	for (uint8_t i = 0; i < 12; i++)
+	{
+		for (uint8_t j = 0; j < 2; j++)
+		{
+			CubeColor colors[2] = {};
+			for (int k = 0; k < 2; k++)
+			{
+				colors[k] = m_edgeColors[i][k ^ j];
+				result.edgeColors[i][j][k] = colors[k];
+			}
+			result.edgePieces[(colors[0] * 6) + colors[1]] = CubePiece { i, j };
+		}
+	}
+	return result;
+}
+
+constexpr Cube3x3::FaceConversionTables Cube3x3::m_faceConversion = GetFaceConversionTables();
+
+constexpr Cube3x3::IndexTables Cube3x3::GetIndexTables()
+{
+	IndexTables result = {};
+	for (int i = 1; i < (1 << 12); i++)
+		result.bitCount[i] = result.bitCount[i >> 1] + (i & 1);
+	result.factorial[0] = 1;
+	for (int i = 1; i < 13; i++)
+		result.factorial[i] = result.factorial[i - 1] * i;
+	for (int n = 0; n < 13; n++)
+	{
+		result.binomial[n][0] = 1;
+		for (int k = 1; k < 5; k++)
+			result.binomial[n][k] = (n == 0) ? 0 : (result.binomial[n - 1][k - 1] + result.binomial[n - 1][k]);
+	}
+	return result;
+}
+
+constexpr Cube3x3::IndexTables Cube3x3::m_indexTables = GetIndexTables();
+
 // Set of moves possible as the first move in phase 1 (all moves)
 Cube3x3::PossibleSearchMoves Cube3x3::m_possiblePhase1Moves = {
 	18, {MOVE_U, MOVE_Up, MOVE_U2, MOVE_F, MOVE_Fp, MOVE_F2, MOVE_R, MOVE_Rp, MOVE_R2,
@@ -321,7 +440,7 @@ Cube3x3::PossibleSearchMoves Cube3x3::m_possiblePhase2FollowupMoves[MOVE_D2 + 1]
 };
 
 // Table of adjacent faces on corners for cubes in face color format
-uint8_t Cube3x3Faces::m_cornerAdjacency[6][4][2] = {
+constexpr uint8_t Cube3x3Faces::m_cornerAdjacency[6][4][2] = {
 	// Top
 	{
 		{IDX(LEFT, 0, 0), IDX(BACK, 0, 2)}, {IDX(BACK, 0, 0), IDX(RIGHT, 0, 2)},
@@ -355,7 +474,7 @@ uint8_t Cube3x3Faces::m_cornerAdjacency[6][4][2] = {
 };
 
 // Table of adjacent faces on edges for cubes in face color format
-uint8_t Cube3x3Faces::m_edgeAdjacency[6][4] = {
+constexpr uint8_t Cube3x3Faces::m_edgeAdjacency[6][4] = {
 	// Top
 	{
 		IDX(BACK, 0, 1),
@@ -396,7 +515,7 @@ uint8_t Cube3x3Faces::m_edgeAdjacency[6][4] = {
 
 // Table for rotation of a face in face color format. Each entry is the
 // index on a face where the new color comes from.
-uint8_t Cube3x3Faces::m_faceRotation[2][9] = {
+constexpr uint8_t Cube3x3Faces::m_faceRotation[2][9] = {
 	// CW
 	{
 		FACE_OFFSET(2, 0), FACE_OFFSET(1, 0), FACE_OFFSET(0, 0),
@@ -414,7 +533,7 @@ uint8_t Cube3x3Faces::m_faceRotation[2][9] = {
 // Table for rotation of edges in face color format. Each entry is the
 // index of the edge where the new color comes from. Edges are numbered
 // as follows: (0, 1), (1, 0), (1, 2), (2, 1)
-uint8_t Cube3x3Faces::m_edgeRotation[2][4] = {
+constexpr uint8_t Cube3x3Faces::m_edgeRotation[2][4] = {
 	// CW
 	{2, 0, 3, 1},
 	// CCW
@@ -424,7 +543,7 @@ uint8_t Cube3x3Faces::m_edgeRotation[2][4] = {
 // Table for rotation of corners in face color format. Each entry is the
 // index of the corner where the new color comes from. Corners are numbered
 // as follows: (0, 0), (0, 1), (2, 0), (2, 2)
-uint8_t Cube3x3Faces::m_cornerRotation[2][4] = {
+constexpr uint8_t Cube3x3Faces::m_cornerRotation[2][4] = {
 	// CW
 	{1, 3, 0, 2},
 	// CCW
@@ -466,79 +585,175 @@ uint8_t Cube3x3Faces::m_edgeIndicies[12][2] = {
 };
 
 
-// Generic implementation of Move() function that calls the Rotate() function
-// for any compatible cube representation.
-template <class T>
-static void MoveWithRotation(T& cube, CubeMove move)
-{
-	switch (move)
-	{
-	case MOVE_U:
-		cube.Rotate(TOP, CW);
-		break;
-	case MOVE_Up:
-		cube.Rotate(TOP, CCW);
-		break;
-	case MOVE_U2:
-		cube.Rotate(TOP, CW);
-		cube.Rotate(TOP, CW);
-		break;
-	case MOVE_F:
-		cube.Rotate(FRONT, CW);
-		break;
-	case MOVE_Fp:
-		cube.Rotate(FRONT, CCW);
-		break;
-	case MOVE_F2:
-		cube.Rotate(FRONT, CW);
-		cube.Rotate(FRONT, CW);
-		break;
-	case MOVE_R:
-		cube.Rotate(RIGHT, CW);
-		break;
-	case MOVE_Rp:
-		cube.Rotate(RIGHT, CCW);
-		break;
-	case MOVE_R2:
-		cube.Rotate(RIGHT, CW);
-		cube.Rotate(RIGHT, CW);
-		break;
-	case MOVE_B:
-		cube.Rotate(BACK, CW);
-		break;
-	case MOVE_Bp:
-		cube.Rotate(BACK, CCW);
-		break;
-	case MOVE_B2:
-		cube.Rotate(BACK, CW);
-		cube.Rotate(BACK, CW);
-		break;
-	case MOVE_L:
-		cube.Rotate(LEFT, CW);
-		break;
-	case MOVE_Lp:
-		cube.Rotate(LEFT, CCW);
-		break;
-	case MOVE_L2:
-		cube.Rotate(LEFT, CW);
-		cube.Rotate(LEFT, CW);
-		break;
-	case MOVE_D:
-		cube.Rotate(BOTTOM, CW);
-		break;
-	case MOVE_Dp:
-		cube.Rotate(BOTTOM, CCW);
-		break;
-	case MOVE_D2:
-		cube.Rotate(BOTTOM, CW);
-		cube.Rotate(BOTTOM, CW);
-		break;
-	default:
-		break;
+constexpr Cube3x3::MoveTable Cube3x3::GetMoveTable(CubeMove move)
+{
+	// Moves are ordered by face in the same order as CubeFace, with half turns as two clockwise turns
+	int face = move / 3;
+	int dir = ((move % 3) == 1) ? CCW : CW;
+	int turns = ((move % 3) == 2) ? 2 : 1;
+
+	MoveTable result = {};
+	for (uint8_t i = 0; i < 8; i++)
+		result.corners[i] = CubePiece { i, 0 };
+	for (uint8_t i = 0; i < 12; i++)
+		result.edges[i] = CubePiece { i, 0 };
+
+	for (int turn = 0; turn < turns; turn++)
+	{
+		MoveTable prev = result;
+		for (int i = 0; i < 8; i++)
+		{
+			CubePiece src = m_cornerRotation[dir][face][i];
+			result.corners[i] = CubePiece { prev.corners[src.piece].piece,
+				(uint8_t)((prev.corners[src.piece].orientation + src.orientation) % 3) };
+		}
+		for (int i = 0; i < 12; i++)
+		{
+			CubePiece src = m_edgeRotation[dir][face][i];
+			result.edges[i] = CubePiece { prev.edges[src.piece].piece,
+				(uint8_t)(prev.edges[src.piece].orientation ^ src.orientation) };
+		}
+	}
+	return result;
+}
+
+
+constexpr Cube3x3::MoveTable Cube3x3::m_moveTables[MOVE_D2 + 1] = {
+	GetMoveTable(MOVE_U), GetMoveTable(MOVE_Up), GetMoveTable(MOVE_U2),
+	GetMoveTable(MOVE_F), GetMoveTable(MOVE_Fp), GetMoveTable(MOVE_F2),
+	GetMoveTable(MOVE_R), GetMoveTable(MOVE_Rp), GetMoveTable(MOVE_R2),
+	GetMoveTable(MOVE_B), GetMoveTable(MOVE_Bp), GetMoveTable(MOVE_B2),
+	GetMoveTable(MOVE_L), GetMoveTable(MOVE_Lp), GetMoveTable(MOVE_L2),
+	GetMoveTable(MOVE_D), GetMoveTable(MOVE_Dp), GetMoveTable(MOVE_D2)
+};
+
+
+template <CubeMove move, size_t... i>
+void Cube3x3::MovePieces(Cube3x3& cube, index_sequence<i...>)
+{
+	CubePiece oldCorners[8];
+	CubePiece oldEdges[12];
+	memcpy(oldCorners, cube.m_corners, sizeof(oldCorners));
+	memcpy(oldEdges, cube.m_edges, sizeof(oldEdges));
+
+	// Indicies 0-7 are the corners and 8-19 are the edges. Pieces that the move does not touch
+	// are skipped at compile time.
+	auto movePiece = [&](auto idx) {
+		constexpr size_t j = decltype(idx)::value;
+		if constexpr (j < 8)
+		{
+			constexpr CubePiece src = m_moveTables[move].corners[j];
+			if constexpr ((src.piece != j) || (src.orientation != 0))
+			{
+				uint8_t orientation = oldCorners[src.piece].orientation + src.orientation;
+				cube.m_corners[j] = CubePiece { oldCorners[src.piece].piece,
+					(uint8_t)((orientation >= 3) ? (orientation - 3) : orientation) };
+			}
+		}
+		else
+		{
+			constexpr CubePiece src = m_moveTables[move].edges[j - 8];
+			if constexpr ((src.piece != (j - 8)) || (src.orientation != 0))
+			{
+				cube.m_edges[j - 8] = CubePiece { oldEdges[src.piece].piece,
+					(uint8_t)(oldEdges[src.piece].orientation ^ src.orientation) };
+			}
+		}
+	};
+	(movePiece(integral_constant<size_t, i>()), ...);
+}
+
+
+template <CubeMove move>
+void Cube3x3::MoveKernel(Cube3x3& cube)
+{
+	MovePieces<move>(cube, make_index_sequence<8 + 12>());
+}
+
+
+void (*const Cube3x3::m_moveKernels[MOVE_D2 + 1])(Cube3x3& cube) = {
+	&MoveKernel<MOVE_U>, &MoveKernel<MOVE_Up>, &MoveKernel<MOVE_U2>,
+	&MoveKernel<MOVE_F>, &MoveKernel<MOVE_Fp>, &MoveKernel<MOVE_F2>,
+	&MoveKernel<MOVE_R>, &MoveKernel<MOVE_Rp>, &MoveKernel<MOVE_R2>,
+	&MoveKernel<MOVE_B>, &MoveKernel<MOVE_Bp>, &MoveKernel<MOVE_B2>,
+	&MoveKernel<MOVE_L>, &MoveKernel<MOVE_Lp>, &MoveKernel<MOVE_L2>,
+	&MoveKernel<MOVE_D>, &MoveKernel<MOVE_Dp>, &MoveKernel<MOVE_D2>
+};
+
+
+constexpr Cube3x3Faces::MoveTable Cube3x3Faces::GetMoveTable(CubeMove move)
+{
+	int face = move / 3;
+	int dir = ((move % 3) == 1) ? CCW : CW;
+	int turns = ((move % 3) == 2) ? 2 : 1;
+
+	MoveTable result = {};
+	for (uint8_t i = 0; i < (6 * 9); i++)
+		result.source[i] = i;
+
+	// Same as Rotate, but moving the source indicies instead of the colors
+	for (int turn = 0; turn < turns; turn++)
+	{
+		MoveTable prev = result;
+		for (int i = 0; i < 9; i++)
+			result.source[FACE_START(face) + i] = prev.source[FACE_START(face) + m_faceRotation[dir][i]];
+		for (int i = 0; i < 4; i++)
+		{
+			int j = m_edgeRotation[dir][i];
+			int k = m_cornerRotation[dir][i];
+			result.source[m_edgeAdjacency[face][j]] = prev.source[m_edgeAdjacency[face][i]];
+			result.source[m_cornerAdjacency[face][k][0]] = prev.source[m_cornerAdjacency[face][i][0]];
+			result.source[m_cornerAdjacency[face][k][1]] = prev.source[m_cornerAdjacency[face][i][1]];
+		}
 	}
+	return result;
+}
+
+
+constexpr Cube3x3Faces::MoveTable Cube3x3Faces::m_moveTables[MOVE_D2 + 1] = {
+	GetMoveTable(MOVE_U), GetMoveTable(MOVE_Up), GetMoveTable(MOVE_U2),
+	GetMoveTable(MOVE_F), GetMoveTable(MOVE_Fp), GetMoveTable(MOVE_F2),
+	GetMoveTable(MOVE_R), GetMoveTable(MOVE_Rp), GetMoveTable(MOVE_R2),
+	GetMoveTable(MOVE_B), GetMoveTable(MOVE_Bp), GetMoveTable(MOVE_B2),
+	GetMoveTable(MOVE_L), GetMoveTable(MOVE_Lp), GetMoveTable(MOVE_L2),
+	GetMoveTable(MOVE_D), GetMoveTable(MOVE_Dp), GetMoveTable(MOVE_D2)
+};
+
+
+template <CubeMove move, size_t... i>
+void Cube3x3Faces::MoveColors(Cube3x3Faces& cube, index_sequence<i...>)
+{
+	CubeColor oldState[6 * 9];
+	memcpy(oldState, cube.m_state, sizeof(oldState));
+
+	// Only the colors that the move changes are written
+	auto moveColor = [&](auto idx) {
+		constexpr size_t j = decltype(idx)::value;
+		constexpr uint8_t src = m_moveTables[move].source[j];
+		if constexpr (src != j)
+			cube.m_state[j] = oldState[src];
+	};
+	(moveColor(integral_constant<size_t, i>()), ...);
+}
+
+
+template <CubeMove move>
+void Cube3x3Faces::MoveKernel(Cube3x3Faces& cube)
+{
+	MoveColors<move>(cube, make_index_sequence<6 * 9>());
 }
 
 
+void (*const Cube3x3Faces::m_moveKernels[MOVE_D2 + 1])(Cube3x3Faces& cube) = {
+	&MoveKernel<MOVE_U>, &MoveKernel<MOVE_Up>, &MoveKernel<MOVE_U2>,
+	&MoveKernel<MOVE_F>, &MoveKernel<MOVE_Fp>, &MoveKernel<MOVE_F2>,
+	&MoveKernel<MOVE_R>, &MoveKernel<MOVE_Rp>, &MoveKernel<MOVE_R2>,
+	&MoveKernel<MOVE_B>, &MoveKernel<MOVE_Bp>, &MoveKernel<MOVE_B2>,
+	&MoveKernel<MOVE_L>, &MoveKernel<MOVE_Lp>, &MoveKernel<MOVE_L2>,
+	&MoveKernel<MOVE_D>, &MoveKernel<MOVE_Dp>, &MoveKernel<MOVE_D2>
+};
+
+
 bool CubePiece::operator==(const CubePiece& other) const
 {
 	return (piece == other.piece) && (orientation == other.orientation);
@@ -562,62 +777,16 @@ Cube3x3::Cube3x3()
 
 Cube3x3::Cube3x3(const Cube3x3Faces& cube)
 {
+	// Look up each piece and orientation directly from its colors
 	for (uint8_t i = 0; i < 8; i++)
 	{
-		CubeColor cornerColors[3] = {
-			cube.GetCornerColor((CubeCorner)i, 0),
-			cube.GetCornerColor((CubeCorner)i, 1),
-			cube.GetCornerColor((CubeCorner)i, 2)};
-
-		// Find this corner piece and orientation
-		for (uint8_t j = 0; j < 8; j++)
-		{
-			if ((cornerColors[0] == m_cornerColors[j][0]) &&
-				(cornerColors[1] == m_cornerColors[j][1]) &&
-				(cornerColors[2] == m_cornerColors[j][2]))
-			{
-				m_corners[i] = CubePiece { j, 0 };
-				break;
-			}
-			else if ((cornerColors[1] == m_cornerColors[j][0]) &&
-				(cornerColors[2] == m_cornerColors[j][1]) &&
-				(cornerColors[0] == m_cornerColors[j][2]))
-			{
-				m_corners[i] = CubePiece { j, 1 };
-				break;
-			}
-			else if ((cornerColors[2] == m_cornerColors[j][0]) &&
-				(cornerColors[0] == m_cornerColors[j][1]) &&
-				(cornerColors[1] == m_cornerColors[j][2]))
-			{
-				m_corners[i] = CubePiece { j, 2 };
-				break;
-			}
-		}
+		m_corners[i] = m_faceConversion.cornerPieces[(cube.GetCornerColor((CubeCorner)i, 0) * 36) +
+			(cube.GetCornerColor((CubeCorner)i, 1) * 6) + cube.GetCornerColor((CubeCorner)i, 2)];
 	}
-
 	for (uint8_t i = 0; i < 12; i++)
 	{
-		CubeColor edgeColors[2] = {
-			cube.GetEdgeColor((CubeEdge)i, 0),
-			cube.GetEdgeColor((CubeEdge)i, 1)};
-
-		// Find this edge piece and orientation
-		for (uint8_t j = 0; j < 12; j++)
-		{
-			if ((edgeColors[0] == m_edgeColors[j][0]) &&
-				(edgeColors[1] == m_edgeColors[j][1]))
-			{
-				m_edges[i] = CubePiece { j, 0 };
-				break;
-			}
-			else if ((edgeColors[1] == m_edgeColors[j][0]) &&
-				(edgeColors[0] == m_edgeColors[j][1]))
-			{
-				m_edges[i] = CubePiece { j, 1 };
-				break;
-			}
-		}
+		m_edges[i] = m_faceConversion.edgePieces[(cube.GetEdgeColor((CubeEdge)i, 0) * 6) +
+			cube.GetEdgeColor((CubeEdge)i, 1)];
 	}
 }
 
@@ -650,64 +819,108 @@ void Cube3x3::Rotate(CubeFace face, CubeRotationDirection dir)
 
 void Cube3x3::Move(CubeMove move)
 {
-	MoveWithRotation(*this, move);
+	m_moveKernels[move](*this);
 }
 
 
 void Cube3x3::Apply(const CubeMoveSequence& moves)
 {
 	for (auto i : moves.moves)
-		Move(i);
+		m_moveKernels[i](*this);
 }
 
 
 void Cube3x3::GenerateRandomState(RandomSource& rng)
 {
-	// Randomize the corner pieces
-	for (int i = 0; i < 7; i++)
-	{
-		int n = rng.Next(8);
-		if (i != n)
-		{
-			// Must swap two corners at a time to avoid parity violation
-			swap(m_corners[i], m_corners[n]);
-			swap(m_corners[6], m_corners[7]);
-		}
-	}
+	SetIndexCube(GenerateRandomIndexCube(rng));
+}
 
-	// Randomize the edge pieces
-	for (int i = 0; i < 11; i++)
-	{
-		int n = rng.Next(12);
-		if (i != n)
-		{
-			// Must swap two edges at a time to avoid parity violation
-			swap(m_edges[i], m_edges[n]);
-			swap(m_edges[10], m_edges[11]);
-		}
-	}
 
-	// Randomize the corner orientations
-	int cornerOrientationSum = 0;
-	for (int i = 0; i < 7; i++)
+Cube3x3::Phase1IndexCube Cube3x3::GenerateRandomIndexCube(RandomSource& rng)
+{
+	Phase1IndexCube cube;
+	cube.cornerPermutation = rng.Next(CORNER_PERMUTATION_INDEX_COUNT);
+	cube.cornerOrientation = rng.Next(CORNER_ORIENTATION_INDEX_COUNT);
+	cube.edgeOrientation = rng.Next(EDGE_ORIENTATION_INDEX_COUNT);
+	cube.distance = 0;
+
+	// The edge permutation is drawn as the sorted edge indicies of the three groups of edges. Choose
+	// the positions of the equatorial edges, then the positions of the top edges from the eight that
+	// are left. The bottom edges take the remaining four positions.
+	int positions[4];
+	SetCombinationIndex(positions, rng.Next(EDGE_SLICE_INDEX_COUNT));
+	uint32_t equatorialMask = 0;
+	for (int i = 0; i < 4; i++)
+		equatorialMask |= 1 << positions[i];
+
+	// Combination indicies below NChooseK(8, 4) only use the first eight positions, which are then
+	// mapped onto the positions not taken by the equatorial edges
+	int freePositions[8];
+	for (int i = 0, j = 0; i < 12; i++)
 	{
-		m_corners[i].orientation = rng.Next(3);
-		cornerOrientationSum += m_corners[i].orientation;
+		if ((equatorialMask & (1 << i)) == 0)
+			freePositions[j++] = i;
 	}
-
-	// Randomize the edge orientations
-	int edgeOrientationSum = 0;
-	for (int i = 0; i < 11; i++)
+	SetCombinationIndex(positions,
+		rng.Next(PHASE_2_SORTED_EDGE_INDEX_COUNT / PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT));
+	uint32_t topMask = 0;
+	for (int i = 0; i < 4; i++)
+		topMask |= 1 << freePositions[positions[i]];
+	uint32_t bottomMask = 0xfff & ~(equatorialMask | topMask);
+
+	// The parity of the edge permutation is the parity of the order within each group, plus the
+	// parity of the way the groups are interleaved. The last digit of the bottom edge order has a
+	// base of two, so draw the rest of the digits and choose the last one to match the parity of the
+	// corners (otherwise it is not solvable).
+	int topOrder = rng.Next(PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT);
+	int equatorialOrder = rng.Next(PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT);
+	int bottomOrder = rng.Next(PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT / 2) * 2;
+	int parity = GetPermutationParity(topOrder, 4) + GetPermutationParity(bottomOrder, 4) +
+		GetPermutationParity(equatorialOrder, 4);
+	for (int i = 0; i < 12; i++)
 	{
-		m_edges[i].orientation = rng.Next(2);
-		edgeOrientationSum += m_edges[i].orientation;
+		// Count the earlier positions that hold edges from a later group. Top edges are before
+		// bottom edges, which are before the equatorial edges.
+		uint32_t earlier = (1 << i) - 1;
+		if (topMask & (1 << i))
+			parity += m_indexTables.bitCount[earlier & (bottomMask | equatorialMask)];
+		else if (bottomMask & (1 << i))
+			parity += m_indexTables.bitCount[earlier & equatorialMask];
 	}
+	if ((parity & 1) != GetPermutationParity(cube.cornerPermutation, 8))
+		bottomOrder++;
+
+	cube.sortedTopEdges = (GetCombinationIndex(topMask) * PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT) + topOrder;
+	cube.sortedBottomEdges = (GetCombinationIndex(bottomMask) * PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT) +
+		bottomOrder;
+	cube.sortedEquatorialEdges = (GetCombinationIndex(equatorialMask) * PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT) +
+		equatorialOrder;
+
+	// The equatorial edge slice index numbers the positions starting from the equatorial slice
+	cube.equatorialEdgeSlice = GetCombinationIndex(((equatorialMask >> EDGE_FR) |
+		(equatorialMask << (12 - EDGE_FR))) & 0xfff);
+	return cube;
+}
 
-	// Make sure all corner orientations add up to a multiple of 3 (otherwise it is not solvable)
-	m_corners[7].orientation = (3 - (cornerOrientationSum % 3)) % 3;
 
-	// Make sure all edge orientations add up to a multiple of 2 (otherwise it is not solvable)
-	m_edges[11].orientation = edgeOrientationSum & 1;
+void Cube3x3::SetIndexCube(const Phase1IndexCube& cube)
+{
+	SetCornerPermutationIndex(cube.cornerPermutation);
+	SetCornerOrientationIndex(cube.cornerOrientation);
+	SetEdgeOrientationIndex(cube.edgeOrientation);
+
+	// The positions of the three groups of edges do not overlap, so together they place every edge
+	const pair<CubeEdge, int> groups[3] = {{EDGE_UR, cube.sortedTopEdges}, {EDGE_DR, cube.sortedBottomEdges},
+		{EDGE_FR, cube.sortedEquatorialEdges}};
+	for (auto& i : groups)
+	{
+		int edgePiecePos[4];
+		uint8_t edgePieces[4];
+		SetCombinationIndex(edgePiecePos, i.second / PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT);
+		SetPermutationIndex(edgePieces, 4, i.second % PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT);
+		for (int j = 0; j < 4; j++)
+			m_edges[edgePiecePos[j]].piece = edgePieces[j] + i.first;
+	}
 }
 
 
@@ -755,6 +968,96 @@ bool Cube3x3::operator!=(const Cube3x3& cube) const
 }
 
 
+int Cube3x3::GetPermutationIndex(const uint8_t* pieces, int count)
+{
+	// Index for a permutation is the representation of the state in the factorial number system
+	// (each digit in the number decreases in base, with the digits representing the index of the
+	// choice in the remaining possible choices). The index of the choice is the number of smaller
+	// pieces that are still remaining, so only the order of the pieces matters and any group of
+	// pieces can be used directly. The last piece has only one choice and is not included.
+	uint32_t remaining = 0;
+	for (int i = 0; i < count; i++)
+		remaining |= 1 << pieces[i];
+
+	int result = 0;
+	for (int i = 0; i < (count - 1); i++)
+	{
+		remaining &= ~(1 << pieces[i]);
+		int cur = m_indexTables.bitCount[remaining & ((1 << pieces[i]) - 1)];
+		result += cur * m_indexTables.factorial[count - 1 - i];
+	}
+	return result;
+}
+
+
+int Cube3x3::GetPermutationParity(int idx, int count)
+{
+	// Each digit of the index is the number of later pieces that are smaller, so the digits add
+	// up to the number of inversions in the permutation
+	int result = 0;
+	for (int i = 0; i < (count - 1); i++)
+		result += (idx / m_indexTables.factorial[count - 1 - i]) % (count - i);
+	return result & 1;
+}
+
+
+void Cube3x3::SetPermutationIndex(uint8_t* pieces, int count, int idx)
+{
+	uint32_t used = 0;
+	for (int i = 0; i < count; i++)
+	{
+		// Find the remaining piece at the index of the choice for this digit
+		int cur = (idx / m_indexTables.factorial[count - 1 - i]) % (count - i);
+		int piece = 0;
+		for (; (used & (1 << piece)) || (cur > 0); piece++)
+		{
+			if ((used & (1 << piece)) == 0)
+				cur--;
+		}
+		pieces[i] = piece;
+		used |= 1 << piece;
+	}
+}
+
+
+int Cube3x3::GetCombinationIndex(const int* positions)
+{
+	// Compute an index for four sorted positions using the combinatorial number system. This
+	// will be an integer between zero (first four positions) and NChooseK(12, 4).
+	return m_indexTables.binomial[positions[0]][1] + m_indexTables.binomial[positions[1]][2] +
+		m_indexTables.binomial[positions[2]][3] + m_indexTables.binomial[positions[3]][4];
+}
+
+
+int Cube3x3::GetCombinationIndex(uint32_t mask)
+{
+	int positions[4];
+	for (int i = 0, j = 0; i < 12; i++)
+	{
+		if (mask & (1 << i))
+			positions[j++] = i;
+	}
+	return GetCombinationIndex(positions);
+}
+
+
+void Cube3x3::SetCombinationIndex(int* positions, int idx)
+{
+	// Each position is the largest that does not go past the remaining index, searching
+	// downwards from the position after it
+	int pos = 12;
+	for (int i = 3; i >= 0; i--)
+	{
+		do
+		{
+			pos--;
+		} while (m_indexTables.binomial[pos][i + 1] > idx);
+		positions[i] = pos;
+		idx -= m_indexTables.binomial[pos][i + 1];
+	}
+}
+
+
 int Cube3x3::GetCornerOrientationIndex()
 {
 	// Index for the corner orientations is a simple base 3 integer representation. The
@@ -768,26 +1071,34 @@ int Cube3x3::GetCornerOrientationIndex()
 }
 
 
-int Cube3x3::GetCornerPermutationIndex()
+void Cube3x3::SetCornerOrientationIndex(int idx)
 {
-	// Index for the corner permutations is the representation of the state in the
-	// factorial number system (each digit in the number decreases in base, with the
-	// digits representing the index of the choice in the remaining possible choices).
-	int result = 0;
-	for (size_t i = 0; i < 7; i++)
+	int total = 0;
+	for (int i = 6; i >= 0; i--)
 	{
-		// Get index in set of remaining options by checking how many of the entries
-		// are greater than this one (which is the index in the sorted list of
-		// remaining options)
-		int cur = 0;
-		for (size_t j = i + 1; j < 8; j++)
-		{
-			if (m_corners[i].piece > m_corners[j].piece)
-				cur++;
-		}
-		result = (result + cur) * (7 - i);
+		m_corners[i].orientation = idx % 3;
+		total += idx % 3;
+		idx /= 3;
 	}
-	return result;
+	m_corners[7].orientation = (3 - (total % 3)) % 3;
+}
+
+
+int Cube3x3::GetCornerPermutationIndex()
+{
+	uint8_t pieces[8];
+	for (size_t i = 0; i < 8; i++)
+		pieces[i] = m_corners[i].piece;
+	return GetPermutationIndex(pieces, 8);
+}
+
+
+void Cube3x3::SetCornerPermutationIndex(int idx)
+{
+	uint8_t pieces[8];
+	SetPermutationIndex(pieces, 8, idx);
+	for (size_t i = 0; i < 8; i++)
+		m_corners[i].piece = pieces[i];
 }
 
 
@@ -804,28 +1115,36 @@ int Cube3x3::GetEdgeOrientationIndex()
 }
 
 
+void Cube3x3::SetEdgeOrientationIndex(int idx)
+{
+	int total = 0;
+	for (int i = 10; i >= 0; i--)
+	{
+		m_edges[i].orientation = idx & 1;
+		total += idx & 1;
+		idx >>= 1;
+	}
+	m_edges[11].orientation = total & 1;
+}
+
+
 int Cube3x3::GetPhase2EdgePermutationIndex()
 {
-	// Index for the edge permutations is the representation of the state in the
-	// factorial number system (each digit in the number decreases in base, with the
-	// digits representing the index of the choice in the remaining possible choices).
 	// This is the phase 2 edge permutation index, which does not include the edges
 	// in the equatorial slice (significantly reducing the count).
-	int result = 0;
-	for (size_t i = 0; i < 7; i++)
-	{
-		// Get index in set of remaining options by checking how many of the entries
-		// are greater than this one (which is the index in the sorted list of
-		// remaining options)
-		int cur = 0;
-		for (size_t j = i + 1; j < 8; j++)
-		{
-			if (m_edges[i].piece > m_edges[j].piece)
-				cur++;
-		}
-		result = (result + cur) * (7 - i);
-	}
-	return result;
+	uint8_t pieces[8];
+	for (size_t i = 0; i < 8; i++)
+		pieces[i] = m_edges[i].piece;
+	return GetPermutationIndex(pieces, 8);
+}
+
+
+void Cube3x3::SetPhase2EdgePermutationIndex(int idx)
+{
+	uint8_t pieces[8];
+	SetPermutationIndex(pieces, 8, idx);
+	for (size_t i = 0; i < 8; i++)
+		m_edges[i].piece = pieces[i];
 }
 
 
@@ -846,50 +1165,299 @@ int Cube3x3::GetEquatorialEdgeSliceIndex()
 			(m_edges[(i + EDGE_FR) % 12].piece <= EDGE_BR))
 			edgePiecePos[j++] = i;
 	}
+	return GetCombinationIndex(edgePiecePos);
+}
 
-	// Compute an index using the combinatorial number system. This will be an integer
-	// between zero (solved) and NChooseK(12, 4).
-	return NChooseK(edgePiecePos[0], 1) + NChooseK(edgePiecePos[1], 2) +
-		NChooseK(edgePiecePos[2], 3) + NChooseK(edgePiecePos[3], 4);
+
+void Cube3x3::SetEquatorialEdgeSliceIndex(int idx)
+{
+	int edgePiecePos[4];
+	SetCombinationIndex(edgePiecePos, idx);
+	uint8_t slicePiece = EDGE_FR;
+	uint8_t otherPiece = EDGE_UR;
+	int j = 0;
+	for (int i = 0; i < 12; i++)
+	{
+		if ((j < 4) && (edgePiecePos[j] == i))
+		{
+			m_edges[(i + EDGE_FR) % 12].piece = slicePiece++;
+			j++;
+		}
+		else
+		{
+			m_edges[(i + EDGE_FR) % 12].piece = otherPiece++;
+		}
+	}
 }
 
 
 int Cube3x3::GetPhase2EquatorialEdgePermutationIndex()
 {
 	// This index is only valid for phase 2 (equatorial edge pieces are already in the slice
-	// but not necessarily in the proper places). Index for the edge permutations is the
-	// representation of the state in the factorial number system (each digit in the number
-	// decreases in base, with the digits representing the index of the choice in the
-	// remaining possible choices).
-	int result = 0;
-	for (size_t i = 0; i < 3; i++)
+	// but not necessarily in the proper places).
+	uint8_t pieces[4];
+	for (size_t i = 0; i < 4; i++)
+		pieces[i] = m_edges[i + EDGE_FR].piece;
+	return GetPermutationIndex(pieces, 4);
+}
+
+
+void Cube3x3::SetPhase2EquatorialEdgePermutationIndex(int idx)
+{
+	uint8_t pieces[4];
+	SetPermutationIndex(pieces, 4, idx);
+	for (size_t i = 0; i < 4; i++)
+		m_edges[i + EDGE_FR].piece = pieces[i] + EDGE_FR;
+}
+
+
+int Cube3x3::GetSortedEdgeIndex(CubeEdge firstEdge)
+{
+	// Index for the position and order of a group of four edges (for example, the equatorial slice
+	// edges). Positions are encoded using the combinatorial number system in the same way as the
+	// equatorial edge slice index, but without reordering the positions. This means that every group
+	// of four edges shares the same move table, and that the top and bottom edges will have an index
+	// below PHASE_2_SORTED_EDGE_INDEX_COUNT while in phase 2. The order of the edges is encoded in the
+	// factorial number system in the same way as the phase 2 equatorial edge permutation index.
+	int edgePiecePos[4];
+	uint8_t edgePieces[4];
+	int j = 0;
+	for (int i = 0; i < 12; i++)
 	{
-		// Get index in set of remaining options by checking how many of the entries
-		// are greater than this one (which is the index in the sorted list of
-		// remaining options)
-		int cur = 0;
-		for (size_t j = i + 1; j < 4; j++)
+		if ((m_edges[i].piece >= firstEdge) && (m_edges[i].piece < (firstEdge + 4)))
 		{
-			if (m_edges[i + EDGE_FR].piece > m_edges[j + EDGE_FR].piece)
-				cur++;
+			edgePiecePos[j] = i;
+			edgePieces[j++] = m_edges[i].piece;
 		}
-		result = (result + cur) * (3 - i);
 	}
-	return result;
+	return (GetCombinationIndex(edgePiecePos) * PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT) +
+		GetPermutationIndex(edgePieces, 4);
 }
 
 
-void Cube3x3::SearchPhase1(Cube3x3SearchState& moves, const Phase1IndexCube& cube, int depth)
+void Cube3x3::SetSortedEdgeIndex(CubeEdge firstEdge, int idx)
 {
-	// Need to go deeper. Iterate through the possible moves.
-	int moveIdx = moves.count++;
-	const PossibleSearchMoves* possibleMoves;
-	if (depth == 1)
+	int edgePiecePos[4];
+	uint8_t edgePieces[4];
+	SetCombinationIndex(edgePiecePos, idx / PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT);
+	SetPermutationIndex(edgePieces, 4, idx % PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT);
+	uint8_t otherPiece = 0;
+	int j = 0;
+	for (int i = 0; i < 12; i++)
 	{
-		if (moveIdx == 0)
-			possibleMoves = &m_possiblePhase1LastMoves;
+		if ((j < 4) && (edgePiecePos[j] == i))
+		{
+			m_edges[i].piece = edgePieces[j++] + firstEdge;
+		}
 		else
-			possibleMoves = &m_possiblePhase1LastFollowupMoves[moves.moves[moveIdx - 1]];
+		{
+			if (otherPiece == firstEdge)
+				otherPiece += 4;
+			m_edges[i].piece = otherPiece++;
+		}
+	}
+}
+
+
+int Cube3x3::GetMod3PruneValue(const uint64_t* table, size_t idx)
+{
+	return (int)((table[idx / 32] >> (2 * (idx % 32))) & 3);
+}
+
+
+int Cube3x3::GetMod3PruneDistance(int parentDistance, int value)
+{
+	// The prune tables only store the move count modulo 3. A single move changes the move count by
+	// at most one, so the exact count can be recovered from the move count of the previous state.
+	return parentDistance + ((value + 4 - (parentDistance % 3)) % 3) - 1;
+}
+
+
+int Cube3x3::GetPhase1PruneValue(const Phase1IndexCube& cube)
+{
+	// Reduce the flip slice index to its symmetry class, and apply the same symmetry to the
+	// corner orientation so that the combined state maps onto the class representative
+	uint32_t flipSlice = m_flipSliceSymTable[cube.edgeOrientation][cube.equatorialEdgeSlice];
+	size_t idx = ((size_t)(flipSlice >> 4) * CORNER_ORIENTATION_INDEX_COUNT) +
+		m_cornerOrientationSymTable[cube.cornerOrientation][flipSlice & 0xf];
+	return GetMod3PruneValue(m_phase1PruneTable, idx);
+}
+
+
+int Cube3x3::GetPhase1Distance(const Phase1IndexCube& cube)
+{
+	// The prune table only stores move counts modulo 3. Find the exact move count by following
+	// moves that bring the cube closer to the phase 1 goal until it is reached.
+	Phase1IndexCube cur = cube;
+	int distance = 0;
+	int pruneValue = GetPhase1PruneValue(cur);
+	while ((cur.cornerOrientation != 0) || (cur.edgeOrientation != 0) || (cur.equatorialEdgeSlice != 0))
+	{
+		for (uint8_t move = MOVE_U; move <= MOVE_D2; move++)
+		{
+			Phase1IndexCube next;
+			next.cornerOrientation = m_cornerOrientationMoveTable[cur.cornerOrientation][move];
+			next.edgeOrientation = m_edgeOrientationMoveTable[cur.edgeOrientation][move];
+			next.equatorialEdgeSlice = m_equatorialEdgeSliceMoveTable[cur.equatorialEdgeSlice][move];
+			int nextPruneValue = GetPhase1PruneValue(next);
+			if (nextPruneValue == ((pruneValue + 2) % 3))
+			{
+				cur = next;
+				pruneValue = nextPruneValue;
+				break;
+			}
+		}
+		distance++;
+	}
+	return distance;
+}
+
+
+int Cube3x3::GetPhase2PruneValue(const Phase2IndexCube& cube)
+{
+	// Reduce the corner permutation to its symmetry class, and apply the same symmetry to the
+	// edge permutation
+	uint16_t cornerPermutation = m_cornerPermutationSymTable[cube.cornerPermutation];
+	size_t idx = ((size_t)(cornerPermutation >> 4) * PHASE_2_EDGE_PERMUTATION_INDEX_COUNT) +
+		m_phase2EdgePermutationSymTable[cube.edgePermutation][cornerPermutation & 0xf];
+	return GetMod3PruneValue(m_phase2PruneTable, idx);
+}
+
+
+bool Cube3x3::IsPhase2Solvable(const Phase2IndexCube& cube, int maxMoves)
+{
+	// Quick check using the smaller tables before finding the exact move count
+	if (m_cornerPermutationPruneTable[cube.cornerPermutation][cube.equatorialEdgePermutation] > maxMoves)
+		return false;
+	return m_phase2EdgePermutationPruneTable[cube.edgePermutation][cube.equatorialEdgePermutation] <= maxMoves;
+}
+
+
+int Cube3x3::GetPhase2Distance(const Phase2IndexCube& cube, int maxMoves)
+{
+	// Find the exact move count by following phase 2 moves that bring the corner and edge
+	// permutations closer to solved, in the same way as for phase 1. Stops once the move count
+	// is known to be more than maxMoves.
+	Phase2IndexCube cur = cube;
+	int distance = 0;
+	int pruneValue = GetPhase2PruneValue(cur);
+	while ((cur.cornerPermutation != 0) || (cur.edgePermutation != 0))
+	{
+		if (distance > maxMoves)
+			break;
+		for (int i = 0; i < m_possiblePhase2Moves.count; i++)
+		{
+			CubeMove move = m_possiblePhase2Moves.moves[i];
+			Phase2IndexCube next;
+			next.cornerPermutation = m_cornerPermutationMoveTable[cur.cornerPermutation][move];
+			next.edgePermutation = m_phase2EdgePermutationMoveTable[cur.edgePermutation][move];
+			int nextPruneValue = GetPhase2PruneValue(next);
+			if (nextPruneValue == ((pruneValue + 2) % 3))
+			{
+				cur = next;
+				pruneValue = nextPruneValue;
+				break;
+			}
+		}
+		distance++;
+	}
+	return distance;
+}
+
+
+static int SharedBestKey(int moveCount, int order)
+{
+	return (moveCount * PARALLEL_SEARCH_ORDER_COUNT) + order;
+}
+
+
+static int MaxMovesForSharedBest(int key, int order)
+{
+	// Solutions are accepted if they have fewer moves than the best solution, or the same number
+	// of moves in a subtree that the serial search would have visited first
+	return (key - order - 1) / PARALLEL_SEARCH_ORDER_COUNT;
+}
+
+
+static CubeMoveSequence BestSolution(const Cube3x3SearchState& moves)
+{
+	CubeMoveSequence result;
+	result.moves.assign(&moves.bestMoves[0], &moves.bestMoves[moves.bestMoveCount]);
+	return result;
+}
+
+
+static void CheckSearchLimits(Cube3x3SearchState& moves)
+{
+	Cube3x3SearchLimitState* limitState = moves.limitState;
+	uint64_t nodeCount = limitState->nodeCount.fetch_add(moves.uncheckedNodes, memory_order_relaxed) +
+		moves.uncheckedNodes;
+	moves.uncheckedNodes = 0;
+
+	if (limitState->stopped.load(memory_order_relaxed))
+	{
+		moves.stopped = true;
+		return;
+	}
+
+	if (limitState->limits.cancel && limitState->limits.cancel->IsCancelled())
+	{
+		limitState->stopped = true;
+		moves.stopped = true;
+		return;
+	}
+
+	// Keep searching until there is a solution to return
+	if (!limitState->solutionFound.load(memory_order_relaxed))
+		return;
+
+	if (((limitState->limits.maxNodes != 0) && (nodeCount >= limitState->limits.maxNodes)) ||
+		(chrono::steady_clock::now() >= limitState->limits.deadline))
+	{
+		limitState->stopped = true;
+		moves.stopped = true;
+	}
+}
+
+
+static void ReportImprovedSolution(Cube3x3SearchState& moves)
+{
+	Cube3x3SearchLimitState* limitState = moves.limitState;
+	lock_guard<mutex> lock(limitState->improvedMutex);
+	limitState->solutionFound = true;
+
+	// Parallel searches can find solutions out of order, only report ones that are shorter
+	if ((size_t)moves.bestMoveCount >= limitState->reportedMoveCount)
+		return;
+	limitState->reportedMoveCount = (size_t)moves.bestMoveCount;
+	if (limitState->limits.improvedFunc)
+		limitState->limits.improvedFunc(BestSolution(moves));
+}
+
+
+void Cube3x3::SearchPhase1(Cube3x3SearchState& moves, const Phase1IndexCube& cube, int depth)
+{
+	SOLVE_STAT(moves, phase1Nodes[depth]);
+	if (moves.limitState && (++moves.uncheckedNodes >= SEARCH_LIMIT_CHECK_INTERVAL))
+	{
+		CheckSearchLimits(moves);
+		if (moves.stopped)
+			return;
+	}
+
+	// Pick up any better solutions found by other workers so that they can be used for pruning
+	if (moves.sharedBest)
+		moves.maxMoves = MaxMovesForSharedBest(moves.sharedBest->load(memory_order_relaxed), moves.order);
+
+	// Need to go deeper. Iterate through the possible moves.
+	int moveIdx = moves.count++;
+	const PossibleSearchMoves* possibleMoves;
+	if (depth == 1)
+	{
+		if (moveIdx == 0)
+			possibleMoves = &m_possiblePhase1LastMoves;
+		else
+			possibleMoves = &m_possiblePhase1LastFollowupMoves[moves.moves[moveIdx - 1]];
 	}
 	else
 	{
@@ -901,6 +1469,8 @@ void Cube3x3::SearchPhase1(Cube3x3SearchState& moves, const Phase1IndexCube& cub
 	for (int i = 0; i < possibleMoves->count; i++)
 	{
 		CubeMove move = possibleMoves->moves[i];
+		if ((moveIdx < moves.fixedMoveCount) && (move != moves.fixedMoves[moveIdx]))
+			continue;
 		moves.moves[moveIdx] = move;
 
 		// Use move tables to transition to the next state for this move
@@ -909,6 +1479,9 @@ void Cube3x3::SearchPhase1(Cube3x3SearchState& moves, const Phase1IndexCube& cub
 		newCube.cornerPermutation = m_cornerPermutationMoveTable[cube.cornerPermutation][move];
 		newCube.edgeOrientation = m_edgeOrientationMoveTable[cube.edgeOrientation][move];
 		newCube.equatorialEdgeSlice = m_equatorialEdgeSliceMoveTable[cube.equatorialEdgeSlice][move];
+		newCube.sortedEquatorialEdges = m_sortedEdgeMoveTable[cube.sortedEquatorialEdges][move];
+		newCube.sortedTopEdges = m_sortedEdgeMoveTable[cube.sortedTopEdges][move];
+		newCube.sortedBottomEdges = m_sortedEdgeMoveTable[cube.sortedBottomEdges][move];
 
 		// Check for solutions
 		if ((newCube.cornerOrientation == 0) && (newCube.edgeOrientation == 0) &&
@@ -917,24 +1490,45 @@ void Cube3x3::SearchPhase1(Cube3x3SearchState& moves, const Phase1IndexCube& cub
 			// Only proceed at the requested depth, we don't want to repeat earlier searches
 			if (depth == 1)
 			{
-				// Translate cube state into phase 2 index form
-				Cube3x3 cubeState = moves.initialState;
-				for (int i = 0; i < moves.count; i++)
-					cubeState.Move(moves.moves[i]);
+				// Phase 2 must solve the corner permutation, skip this phase 1 solution if it can't
+				// lead to a better solution than what we already have
+				if ((int)(moves.count + m_phase1CornerPermutationPruneTable[newCube.cornerPermutation]) > moves.maxMoves)
+				{
+					SOLVE_STAT(moves, phase1CornerPermutationPruneCuts);
+					continue;
+				}
+
+				// Translate cube state into phase 2 index form. The equatorial and bottom edges are
+				// in their solved positions, so only their order remains in the sorted edge indicies.
 				Phase2IndexCube phase2Cube;
 				phase2Cube.cornerPermutation = newCube.cornerPermutation;
-				phase2Cube.edgePermutation = cubeState.GetPhase2EdgePermutationIndex();
-				phase2Cube.equatorialEdgePermutation = cubeState.GetPhase2EquatorialEdgePermutationIndex();
+				phase2Cube.edgePermutation = m_phase2EdgePermutationMergeTable[newCube.sortedTopEdges]
+					[newCube.sortedBottomEdges % PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT];
+				phase2Cube.equatorialEdgePermutation = newCube.sortedEquatorialEdges %
+					PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT;
+				if (!IsPhase2Solvable(phase2Cube, moves.maxMoves - moves.count))
+				{
+					SOLVE_STAT(moves, phase2SolvableCuts);
+					continue;
+				}
 
-				// Search for phase 2 solution using iterative deepening. Do not go beyond the maximum
-				// number of moves for the whole solve.
-				for (int i = 0; i < (moves.maxMoves - moves.count); i++)
+				SOLVE_STAT(moves, phase2Entries);
 				{
-					if (SearchPhase2(moves, phase2Cube, i))
-						break;
+					SOLVE_STAT_NESTED_TIMER(moves, phase2Time, phase1Time);
+					phase2Cube.distance = GetPhase2Distance(phase2Cube, moves.maxMoves - moves.count);
+
+					// Search for phase 2 solution using iterative deepening. Do not go beyond the maximum
+					// number of moves for the whole solve.
+					for (int i = phase2Cube.distance; i <= (moves.maxMoves - moves.count); i++)
+					{
+						if (SearchPhase2(moves, phase2Cube, i) || moves.stopped)
+							break;
+					}
 				}
-				if (!moves.optimal && (moves.bestSolution.moves.size() != 0))
-					return;
+				if (!moves.optimal && (moves.bestMoveCount != 0))
+					break;
+				if (moves.stopped)
+					break;
 			}
 			continue;
 		}
@@ -942,23 +1536,29 @@ void Cube3x3::SearchPhase1(Cube3x3SearchState& moves, const Phase1IndexCube& cub
 		if (depth == 1)
 			continue;
 
-		if ((int)((m_combinedOrientationPruneTable[newCube.cornerOrientation][newCube.edgeOrientation / 8] >>
-			(4 * (newCube.edgeOrientation & 7))) & 0xf) >= depth)
-			continue;
-		if (m_cornerOrientationPruneTable[newCube.cornerOrientation][newCube.equatorialEdgeSlice] >= depth)
-			continue;
-		if (m_edgeOrientationPruneTable[newCube.edgeOrientation][newCube.equatorialEdgeSlice] >= depth)
+		newCube.distance = GetMod3PruneDistance(cube.distance, GetPhase1PruneValue(newCube));
+		if (newCube.distance >= depth)
+		{
+			SOLVE_STAT(moves, phase1PruneCuts);
 			continue;
-		if ((int)(moves.count + m_phase1CornerPermutationPruneTable[newCube.cornerPermutation]) > moves.maxMoves)
+		}
+
+		// Any solution from here must also solve the corner permutation
+		if ((int)(moves.count + m_cornerPermutationAllMovesPruneTable[newCube.cornerPermutation]) > moves.maxMoves)
+		{
+			SOLVE_STAT(moves, cornerPermutationAllMovesPruneCuts);
 			continue;
+		}
 
 		// Proceed further into phase 1
 		SearchPhase1(moves, newCube, depth - 1);
 
-		if (!moves.optimal && (moves.bestSolution.moves.size() != 0))
+		if (!moves.optimal && (moves.bestMoveCount != 0))
 			break;
 		if (moves.count > moves.maxMoves)
 			break;
+		if (moves.stopped)
+			break;
 	}
 	moves.count--;
 }
@@ -968,20 +1568,59 @@ bool Cube3x3::SearchPhase2(Cube3x3SearchState& moves, const Phase2IndexCube& cub
 {
 	if ((cube.cornerPermutation == 0) && (cube.edgePermutation == 0) && (cube.equatorialEdgePermutation == 0))
 	{
-		if ((moves.bestSolution.moves.size() == 0) || (moves.count < (int)moves.bestSolution.moves.size()))
+		if (moves.sharedBest)
+		{
+			// Only keep this solution if it is better than the ones found by all other workers
+			int key = SharedBestKey(moves.count, moves.order);
+			int best = moves.sharedBest->load(memory_order_relaxed);
+			while ((key < best) && !moves.sharedBest->compare_exchange_weak(best, key));
+			if (key < best)
+			{
+				memcpy(moves.bestMoves, moves.moves, sizeof(CubeMove) * moves.count);
+				moves.bestMoveCount = moves.count;
+				moves.bestOrder = moves.order;
+				if (moves.limitState)
+					ReportImprovedSolution(moves);
+			}
+			moves.maxMoves = MaxMovesForSharedBest(moves.sharedBest->load(memory_order_relaxed), moves.order);
+		}
+		else if ((moves.bestMoveCount == 0) || (moves.count < moves.bestMoveCount))
 		{
-			moves.bestSolution.moves = vector<CubeMove>(&moves.moves[0], &moves.moves[moves.count]);
+			memcpy(moves.bestMoves, moves.moves, sizeof(CubeMove) * moves.count);
+			moves.bestMoveCount = moves.count;
+			moves.bestOrder = moves.order;
 			moves.maxMoves = moves.count - 1;
+			if (moves.limitState)
+				ReportImprovedSolution(moves);
 		}
 		return true;
 	}
 
 	if (depth > 0)
 	{
+		if (moves.limitState && (++moves.uncheckedNodes >= SEARCH_LIMIT_CHECK_INTERVAL))
+		{
+			CheckSearchLimits(moves);
+			if (moves.stopped)
+				return false;
+		}
+
+		SOLVE_STAT(moves, phase2Nodes[depth]);
+		if (cube.distance > depth)
+		{
+			SOLVE_STAT(moves, phase2PruneCuts);
+			return false;
+		}
 		if (m_cornerPermutationPruneTable[cube.cornerPermutation][cube.equatorialEdgePermutation] > depth)
+		{
+			SOLVE_STAT(moves, cornerPermutationPruneCuts);
 			return false;
+		}
 		if (m_phase2EdgePermutationPruneTable[cube.edgePermutation][cube.equatorialEdgePermutation] > depth)
+		{
+			SOLVE_STAT(moves, phase2EdgePermutationPruneCuts);
 			return false;
+		}
 
 		// Need to go deeper. Iterate through the possible moves.
 		int moveIdx = moves.count++;
@@ -1000,6 +1639,7 @@ bool Cube3x3::SearchPhase2(Cube3x3SearchState& moves, const Phase2IndexCube& cub
 			newCube.cornerPermutation = m_cornerPermutationMoveTable[cube.cornerPermutation][move];
 			newCube.edgePermutation = m_phase2EdgePermutationMoveTable[cube.edgePermutation][move];
 			newCube.equatorialEdgePermutation = m_phase2EquatorialEdgePermutationMoveTable[cube.equatorialEdgePermutation][move];
+			newCube.distance = GetMod3PruneDistance(cube.distance, GetPhase2PruneValue(newCube));
 
 			// Proceed further into phase 2
 			if (SearchPhase2(moves, newCube, depth - 1))
@@ -1007,6 +1647,8 @@ bool Cube3x3::SearchPhase2(Cube3x3SearchState& moves, const Phase2IndexCube& cub
 				moves.count--;
 				return true;
 			}
+			if (moves.stopped)
+				break;
 		}
 		moves.count--;
 	}
@@ -1014,52 +1656,523 @@ bool Cube3x3::SearchPhase2(Cube3x3SearchState& moves, const Phase2IndexCube& cub
 }
 
 
+Cube3x3::Phase1IndexCube Cube3x3::MoveIndexCube(const Phase1IndexCube& cube, CubeMove move)
+{
+	Phase1IndexCube result;
+	result.cornerOrientation = m_cornerOrientationMoveTable[cube.cornerOrientation][move];
+	result.cornerPermutation = m_cornerPermutationMoveTable[cube.cornerPermutation][move];
+	result.edgeOrientation = m_edgeOrientationMoveTable[cube.edgeOrientation][move];
+	result.equatorialEdgeSlice = m_equatorialEdgeSliceMoveTable[cube.equatorialEdgeSlice][move];
+	result.distance = GetMod3PruneDistance(cube.distance, GetPhase1PruneValue(result));
+	result.sortedEquatorialEdges = m_sortedEdgeMoveTable[cube.sortedEquatorialEdges][move];
+	result.sortedTopEdges = m_sortedEdgeMoveTable[cube.sortedTopEdges][move];
+	result.sortedBottomEdges = m_sortedEdgeMoveTable[cube.sortedBottomEdges][move];
+	return result;
+}
+
+
+uint64_t Cube3x3::GetEndgameKey(const Phase1IndexCube& cube)
+{
+	// The sorted edge indicies of the three groups of edges together give the edge permutation. There
+	// are more cube states than 64 bit keys, so different states can have the same key. Solutions
+	// from the table are checked before they are used.
+	uint64_t key = ((uint64_t)cube.cornerPermutation * CORNER_ORIENTATION_INDEX_COUNT) + cube.cornerOrientation;
+	key = (key * EDGE_ORIENTATION_INDEX_COUNT) + cube.edgeOrientation;
+	key = (key * SORTED_EDGE_INDEX_COUNT) + cube.sortedTopEdges;
+	key = (key * SORTED_EDGE_INDEX_COUNT) + cube.sortedBottomEdges;
+	return (key * SORTED_EDGE_INDEX_COUNT) + cube.sortedEquatorialEdges;
+}
+
+
+int Cube3x3::FindEndgameEntry(uint64_t key)
+{
+	for (size_t i = (size_t)((key * 0x9e3779b97f4a7c15ULL) >> (64 - ENDGAME_TABLE_BITS)); ;
+		i = (i + 1) & (ENDGAME_TABLE_SIZE - 1))
+	{
+		if (m_endgameTable[i] == 0xff)
+			return -1;
+		if (m_endgameKeys[i] == key)
+			return (int)i;
+	}
+}
+
+
+int Cube3x3::GetEndgameDistance(const Phase1IndexCube& cube)
+{
+	// Lower bound for the number of moves to solve the whole cube, which is zero only when solved
+	int distance = max(cube.distance, (int)m_cornerPermutationAllMovesPruneTable[cube.cornerPermutation]);
+	distance = max(distance, (int)m_sortedEdgeAllMovesPruneTable[0][cube.sortedTopEdges]);
+	distance = max(distance, (int)m_sortedEdgeAllMovesPruneTable[1][cube.sortedBottomEdges]);
+	return max(distance, (int)m_sortedEdgeAllMovesPruneTable[2][cube.sortedEquatorialEdges]);
+}
+
+
+int Cube3x3::GetEndgameSolution(const Phase1IndexCube& cube, CubeMove* solution)
+{
+	int entry = FindEndgameEntry(GetEndgameKey(cube));
+	if (entry < 0)
+		return -1;
+
+	// Follow the moves towards solved from each state, checking that each state is the one
+	// that was stored in the table
+	int count = m_endgameTable[entry] >> 5;
+	Phase1IndexCube cur = cube;
+	for (int i = 0; i < count; i++)
+	{
+		if ((entry < 0) || ((m_endgameTable[entry] >> 5) != (count - i)))
+			return -1;
+		solution[i] = (CubeMove)(m_endgameTable[entry] & 0x1f);
+		cur = MoveIndexCube(cur, solution[i]);
+		entry = FindEndgameEntry(GetEndgameKey(cur));
+	}
+	if (GetEndgameDistance(cur) != 0)
+		return -1;
+	return count;
+}
+
+
+bool Cube3x3::SearchEndgame(Cube3x3SearchState& moves, const Phase1IndexCube& cube, int depth)
+{
+	SOLVE_STAT(moves, endgameNodes);
+
+	// The state must be within reach of the table after the remaining moves
+	if (GetEndgameDistance(cube) > (depth + MAX_3X3_ENDGAME_TABLE_MOVES))
+		return false;
+
+	if (depth == 0)
+	{
+		// Any state found in the table at this depth gives an optimal solution, as the searches
+		// with fewer moves did not reach the table
+		int count = GetEndgameSolution(cube, &moves.moves[moves.count]);
+		if (count < 0)
+			return false;
+		moves.count += count;
+		return true;
+	}
+
+	if (moves.limitState && (++moves.uncheckedNodes >= SEARCH_LIMIT_CHECK_INTERVAL))
+	{
+		CheckSearchLimits(moves);
+		if (moves.stopped)
+			return false;
+	}
+
+	int moveIdx = moves.count++;
+	const PossibleSearchMoves* possibleMoves;
+	if (moveIdx == 0)
+		possibleMoves = &m_possiblePhase1Moves;
+	else
+		possibleMoves = &m_possiblePhase1FollowupMoves[moves.moves[moveIdx - 1]];
+	for (int i = 0; i < possibleMoves->count; i++)
+	{
+		CubeMove move = possibleMoves->moves[i];
+		moves.moves[moveIdx] = move;
+		if (SearchEndgame(moves, MoveIndexCube(cube, move), depth - 1))
+			return true;
+		if (moves.stopped)
+			break;
+	}
+	moves.count--;
+	return false;
+}
+
+
+bool Cube3x3::SearchEndgameToDepth(Cube3x3SearchState& moves, const Phase1IndexCube& cube, int maxMoves)
+{
+	SOLVE_STAT_TIMER(moves, endgameTime);
+
+	// Search outwards from the cube state until a state in the endgame table is reached
+	for (int depth = 0; depth <= (maxMoves - MAX_3X3_ENDGAME_TABLE_MOVES); depth++)
+	{
+		moves.count = 0;
+		if (SearchEndgame(moves, cube, depth))
+		{
+			memcpy(moves.bestMoves, moves.moves, sizeof(CubeMove) * moves.count);
+			moves.bestMoveCount = moves.count;
+			moves.maxMoves = moves.count - 1;
+			if (moves.limitState)
+				ReportImprovedSolution(moves);
+			return true;
+		}
+		if (moves.stopped)
+			break;
+	}
+	moves.count = 0;
+	return false;
+}
+
+
+void Cube3x3::SearchPhase1Parallel(Cube3x3SearchState& moves, const Phase1IndexCube& cube, size_t threadCount)
+{
+	// Shallow searches are too small to be worth splitting up, run them on this thread
+	{
+		SOLVE_STAT_TIMER(moves, phase1Time);
+		for (int depth = cube.distance; (depth < PARALLEL_SEARCH_MIN_DEPTH) && (depth <= moves.maxMoves); depth++)
+			SearchPhase1(moves, cube, depth);
+	}
+	if (moves.stopped)
+		return;
+
+	// Split the remaining searches into subtrees by the first two moves. These are ordered
+	// in the same way that the serial search would visit them.
+	struct Subtree
+	{
+		int depth;
+		CubeMove moves[2];
+	};
+	vector<Subtree> subtrees;
+	for (int depth = max(cube.distance, PARALLEL_SEARCH_MIN_DEPTH); depth <= MAX_3x3_PHASE_1_MOVES; depth++)
+	{
+		for (int i = 0; i < m_possiblePhase1Moves.count; i++)
+		{
+			CubeMove first = m_possiblePhase1Moves.moves[i];
+			const PossibleSearchMoves& followup = m_possiblePhase1FollowupMoves[first];
+			for (int j = 0; j < followup.count; j++)
+				subtrees.push_back(Subtree { depth, { first, followup.moves[j] } });
+		}
+	}
+
+	// Order zero is reserved for solutions found before the parallel search started
+	atomic<int> sharedBest(SharedBestKey(moves.maxMoves + 1, 0));
+	atomic<size_t> nextSubtree(0);
+	vector<Cube3x3SearchState> workerMoves(threadCount, moves);
+	vector<thread> workers;
+	for (size_t i = 0; i < threadCount; i++)
+	{
+		workerMoves[i].bestMoveCount = 0;
+		workerMoves[i].sharedBest = &sharedBest;
+		workerMoves[i].fixedMoveCount = 2;
+#ifdef CUBE3X3_SOLVE_STATS
+		workerMoves[i].stats = Cube3x3SolveStats();
+#endif
+		workers.push_back(thread([&, i]() {
+			Cube3x3SearchState& workerState = workerMoves[i];
+			SOLVE_STAT_TIMER(workerState, phase1Time);
+			while (!workerState.stopped)
+			{
+				size_t subtreeIdx = nextSubtree.fetch_add(1);
+				if (subtreeIdx >= subtrees.size())
+					break;
+
+				const Subtree& subtree = subtrees[subtreeIdx];
+				workerState.count = 0;
+				workerState.order = (int)subtreeIdx + 1;
+				workerState.fixedMoves[0] = subtree.moves[0];
+				workerState.fixedMoves[1] = subtree.moves[1];
+				workerState.maxMoves = MaxMovesForSharedBest(sharedBest.load(), workerState.order);
+				if (subtree.depth > workerState.maxMoves)
+					continue;
+				SearchPhase1(workerState, cube, subtree.depth);
+			}
+		}));
+	}
+	for (auto& i : workers)
+		i.join();
+
+	// Collect the best solution from the worker that found it
+	int best = sharedBest.load();
+	for (auto& i : workerMoves)
+	{
+#ifdef CUBE3X3_SOLVE_STATS
+		moves.stats.Add(i.stats);
+#endif
+		if ((i.bestMoveCount != 0) && (SharedBestKey(i.bestMoveCount, i.bestOrder) == best))
+		{
+			memcpy(moves.bestMoves, i.bestMoves, sizeof(CubeMove) * i.bestMoveCount);
+			moves.bestMoveCount = i.bestMoveCount;
+			moves.maxMoves = moves.bestMoveCount - 1;
+		}
+	}
+}
+
+
+atomic<Cube3x3SolutionCache*> Cube3x3::m_solutionCache(nullptr);
+
+
 CubeMoveSequence Cube3x3::Solve(bool optimal)
+{
+	return Solve(optimal, 1);
+}
+
+
+CubeMoveSequence Cube3x3::Solve(bool optimal, size_t threadCount)
+{
+	// The parallel search gives the same result as the serial search, so the thread count is not
+	// part of the cache key
+	Cube3x3SolutionCache* cache = m_solutionCache.load();
+	CubeMoveSequence result;
+	if (cache && cache->Find(*this, optimal, result))
+		return result;
+
+	Cube3x3SearchState moves;
+	Search(moves, optimal, threadCount, nullptr);
+	result = BestSolution(moves);
+
+	// Don't cache failures to load the solver tables
+	if (cache && (IsSolved() || (moves.bestMoveCount != 0)))
+		cache->Insert(*this, optimal, result);
+	return result;
+}
+
+
+void Cube3x3::SetSolutionCache(Cube3x3SolutionCache* cache)
+{
+	m_solutionCache = cache;
+}
+
+
+CubeMoveSequence Cube3x3::Solve(const Cube3x3SolveLimits& limits, size_t threadCount)
+{
+	Cube3x3SearchState moves;
+	Cube3x3SearchLimitState limitState(limits);
+	Search(moves, true, threadCount, &limitState);
+	if (limits.cancel && limits.cancel->IsCancelled())
+		return CubeMoveSequence();
+	return BestSolution(moves);
+}
+
+
+vector<CubeMoveSequence> Cube3x3::SolveBatch(const vector<Cube3x3>& cubes, const Cube3x3BatchSolveOptions& options)
+{
+	size_t threadCount = options.threadCount;
+	if (threadCount == 0)
+		threadCount = thread::hardware_concurrency();
+	if (threadCount > cubes.size())
+		threadCount = cubes.size();
+
+	// Each worker takes the next unsolved cube and reuses its search state for every cube it solves
+	vector<CubeMoveSequence> results(cubes.size());
+	atomic<size_t> nextCube(0);
+	auto worker = [&]() {
+		Cube3x3SearchState moves;
+		Cube3x3SolveLimits limits = options.limits;
+		while (true)
+		{
+			size_t cubeIdx = nextCube.fetch_add(1);
+			if (cubeIdx >= cubes.size())
+				break;
+
+			// Each solve gets its own time limit, but never runs past the deadline for the batch
+			if (options.solveTimeLimit != chrono::steady_clock::duration::zero())
+				limits.deadline = min(options.limits.deadline, chrono::steady_clock::now() + options.solveTimeLimit);
+
+			Cube3x3 cube = cubes[cubeIdx];
+			Cube3x3SearchLimitState limitState(limits);
+			cube.Search(moves, options.optimal, 1, &limitState);
+			if (!options.limits.cancel || !options.limits.cancel->IsCancelled())
+				results[cubeIdx] = BestSolution(moves);
+		}
+	};
+
+	if (threadCount <= 1)
+	{
+		worker();
+		return results;
+	}
+
+	vector<thread> workers;
+	for (size_t i = 0; i < threadCount; i++)
+		workers.push_back(thread(worker));
+	for (auto& i : workers)
+		i.join();
+	return results;
+}
+
+
+void Cube3x3Solver::Solve(const Cube3x3& cube, CubeMoveSequence& result, bool optimal)
+{
+	Cube3x3 state = cube;
+	state.Search(m_state, optimal, 1, nullptr);
+	result.moves.assign(&m_state.bestMoves[0], &m_state.bestMoves[m_state.bestMoveCount]);
+}
+
+
+void Cube3x3Solver::Solve(const Cube3x3& cube, const Cube3x3SolveLimits& limits, CubeMoveSequence& result)
+{
+	Cube3x3 state = cube;
+	Cube3x3SearchLimitState limitState(limits);
+	state.Search(m_state, true, 1, &limitState);
+	if (limits.cancel && limits.cancel->IsCancelled())
+		result.moves.clear();
+	else
+		result.moves.assign(&m_state.bestMoves[0], &m_state.bestMoves[m_state.bestMoveCount]);
+}
+
+
+Cube3x3SolveStats Cube3x3Solver::GetLastSolveStats() const
+{
+#ifdef CUBE3X3_SOLVE_STATS
+	return m_state.stats;
+#else
+	return Cube3x3SolveStats();
+#endif
+}
+
+
+void Cube3x3SolveStats::Add(const Cube3x3SolveStats& other)
+{
+	for (size_t i = 0; i <= MAX_3X3_SOLUTION_MOVES; i++)
+	{
+		phase1Nodes[i] += other.phase1Nodes[i];
+		phase2Nodes[i] += other.phase2Nodes[i];
+	}
+	endgameNodes += other.endgameNodes;
+	phase1PruneCuts += other.phase1PruneCuts;
+	cornerPermutationAllMovesPruneCuts += other.cornerPermutationAllMovesPruneCuts;
+	phase1CornerPermutationPruneCuts += other.phase1CornerPermutationPruneCuts;
+	phase2SolvableCuts += other.phase2SolvableCuts;
+	phase2PruneCuts += other.phase2PruneCuts;
+	cornerPermutationPruneCuts += other.cornerPermutationPruneCuts;
+	phase2EdgePermutationPruneCuts += other.phase2EdgePermutationPruneCuts;
+	phase2Entries += other.phase2Entries;
+	phase1Time += other.phase1Time;
+	phase2Time += other.phase2Time;
+	endgameTime += other.endgameTime;
+}
+
+
+string Cube3x3SolveStats::ToString() const
+{
+	char line[128];
+	string result;
+	uint64_t phase1Total = 0;
+	uint64_t phase2Total = 0;
+	for (size_t i = 0; i <= MAX_3X3_SOLUTION_MOVES; i++)
+	{
+		phase1Total += phase1Nodes[i];
+		phase2Total += phase2Nodes[i];
+	}
+
+	auto ms = [](chrono::steady_clock::duration d) {
+		return chrono::duration<double, milli>(d).count();
+	};
+	snprintf(line, sizeof(line), "Phase 1: %llu nodes, %.3f ms\n", (unsigned long long)phase1Total, ms(phase1Time));
+	result += line;
+	snprintf(line, sizeof(line), "Phase 2: %llu nodes, %llu entries, %.3f ms\n", (unsigned long long)phase2Total,
+		(unsigned long long)phase2Entries, ms(phase2Time));
+	result += line;
+	snprintf(line, sizeof(line), "Endgame: %llu nodes, %.3f ms\n", (unsigned long long)endgameNodes, ms(endgameTime));
+	result += line;
+
+	// Nodes by remaining depth, only listing depths that were searched
+	for (size_t i = 0; i <= MAX_3X3_SOLUTION_MOVES; i++)
+	{
+		if ((phase1Nodes[i] == 0) && (phase2Nodes[i] == 0))
+			continue;
+		snprintf(line, sizeof(line), "  Depth %2d: %llu phase 1, %llu phase 2\n", (int)i,
+			(unsigned long long)phase1Nodes[i], (unsigned long long)phase2Nodes[i]);
+		result += line;
+	}
+
+	// Cuts by each prune table, as a percentage of the nodes in the phase it is used in
+	auto cuts = [&](const char* name, uint64_t count, uint64_t total) {
+		snprintf(line, sizeof(line), "  %s: %llu cuts (%.1f%%)\n", name, (unsigned long long)count,
+			(total == 0) ? 0.0 : (100.0 * count / total));
+		result += line;
+	};
+	cuts("Phase 1 prune", phase1PruneCuts, phase1Total);
+	cuts("Corner permutation all moves prune", cornerPermutationAllMovesPruneCuts, phase1Total);
+	cuts("Phase 1 corner permutation prune", phase1CornerPermutationPruneCuts, phase1Total);
+	cuts("Phase 2 solvable", phase2SolvableCuts, phase1Total);
+	cuts("Phase 2 prune", phase2PruneCuts, phase2Total);
+	cuts("Corner permutation prune", cornerPermutationPruneCuts, phase2Total);
+	cuts("Phase 2 edge permutation prune", phase2EdgePermutationPruneCuts, phase2Total);
+	return result;
+}
+
+
+void Cube3x3::Search(Cube3x3SearchState& moves, bool optimal, size_t threadCount, Cube3x3SearchLimitState* limitState)
 {
 	// If already solved, solution is zero moves
+	moves.bestMoveCount = 0;
 	if (IsSolved())
-		return CubeMoveSequence();
+		return;
+	if (!LoadTables())
+		return;
 
 	Phase1IndexCube cube;
 	cube.cornerOrientation = GetCornerOrientationIndex();
 	cube.cornerPermutation = GetCornerPermutationIndex();
 	cube.edgeOrientation = GetEdgeOrientationIndex();
 	cube.equatorialEdgeSlice = GetEquatorialEdgeSliceIndex();
+	cube.sortedEquatorialEdges = GetSortedEdgeIndex(EDGE_FR);
+	cube.sortedTopEdges = GetSortedEdgeIndex(EDGE_UR);
+	cube.sortedBottomEdges = GetSortedEdgeIndex(EDGE_DR);
+	SearchIndexCube(moves, cube, optimal, threadCount, limitState);
+}
+
+
+void Cube3x3::SearchIndexCube(Cube3x3SearchState& moves, Phase1IndexCube cube, bool optimal, size_t threadCount,
+	Cube3x3SearchLimitState* limitState)
+{
+	moves.bestMoveCount = 0;
+	cube.distance = GetPhase1Distance(cube);
 
-	Cube3x3SearchState moves;
-	moves.initialState = *this;
 	moves.count = 0;
 	moves.optimal = optimal;
 	moves.maxMoves = MAX_3X3_SOLUTION_MOVES;
+	moves.fixedMoveCount = 0;
+	moves.order = 0;
+	moves.bestOrder = 0;
+	moves.sharedBest = nullptr;
+	moves.limitState = limitState;
+	moves.uncheckedNodes = 0;
+	moves.stopped = false;
+#ifdef CUBE3X3_SOLVE_STATS
+	moves.stats = Cube3x3SolveStats();
+#endif
+
+	if (threadCount == 0)
+		threadCount = thread::hardware_concurrency();
+
+	// States close to solved are solved directly from the endgame table
+	if (SearchEndgameToDepth(moves, cube, MAX_3X3_ENDGAME_TABLE_MOVES) || moves.stopped)
+		return;
 
 	if ((cube.cornerOrientation == 0) && (cube.edgeOrientation == 0) &&
 		(cube.equatorialEdgeSlice == 0))
 	{
 		// Phase 1 is already solved, translate cube state into phase 2 index form
+		SOLVE_STAT(moves, phase2Entries);
+		SOLVE_STAT_TIMER(moves, phase2Time);
 		Phase2IndexCube phase2Cube;
 		phase2Cube.cornerPermutation = cube.cornerPermutation;
-		phase2Cube.edgePermutation = GetPhase2EdgePermutationIndex();
-		phase2Cube.equatorialEdgePermutation = GetPhase2EquatorialEdgePermutationIndex();
+		phase2Cube.edgePermutation = m_phase2EdgePermutationMergeTable[cube.sortedTopEdges]
+			[cube.sortedBottomEdges % PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT];
+		phase2Cube.equatorialEdgePermutation = cube.sortedEquatorialEdges %
+			PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT;
+		phase2Cube.distance = GetPhase2Distance(phase2Cube, moves.maxMoves - moves.count);
 
 		// Search for phase 2 solution using iterative deepening. Do not go beyond the maximum
 		// number of moves for the whole solve.
-		for (int i = 0; i < (moves.maxMoves - moves.count); i++)
+		for (int i = phase2Cube.distance; i <= (moves.maxMoves - moves.count); i++)
 		{
-			if (SearchPhase2(moves, phase2Cube, i))
+			if (SearchPhase2(moves, phase2Cube, i) || moves.stopped)
 				break;
 		}
 	}
+	else if (optimal && (threadCount > 1))
+	{
+		SearchPhase1Parallel(moves, cube, threadCount);
+	}
 	else
 	{
-		for (int depth = 0; (depth <= MAX_3x3_PHASE_1_MOVES) && (depth <= moves.maxMoves); depth++)
+		SOLVE_STAT_TIMER(moves, phase1Time);
+		for (int depth = cube.distance; (depth <= MAX_3x3_PHASE_1_MOVES) && (depth <= moves.maxMoves) &&
+			!moves.stopped; depth++)
 			SearchPhase1(moves, cube, depth);
 	}
-	return moves.bestSolution;
+
+	// The two phase search does not always find the shortest solution. If the solution is short,
+	// search outwards to meet the endgame table, which finds a shorter solution if there is one.
+	if (optimal && !moves.stopped && (moves.bestMoveCount <= MAX_3X3_ENDGAME_SEARCH_MOVES))
+		SearchEndgameToDepth(moves, cube, moves.bestMoveCount - 1);
 }
 
 
 Cube3x3Faces::Cube3x3Faces()
 {
+	memset(m_state, 0, sizeof(m_state));
 	for (size_t i = 0; i < 9; i++)
 	{
 		m_state[FACE_START(TOP) + i] = WHITE;
@@ -1074,6 +2187,7 @@ Cube3x3Faces::Cube3x3Faces()
 
 Cube3x3Faces::Cube3x3Faces(const Cube3x3& cube)
 {
+	memset(m_state, 0, sizeof(m_state));
 	m_state[IDX(TOP, 1, 1)] = WHITE;
 	m_state[IDX(FRONT, 1, 1)] = GREEN;
 	m_state[IDX(RIGHT, 1, 1)] = RED;
@@ -1085,26 +2199,19 @@ Cube3x3Faces::Cube3x3Faces(const Cube3x3& cube)
 	for (size_t i = 0; i < 8; i++)
 	{
 		const CubePiece& piece = cube.Corner((CubeCorner)i);
-		for (size_t j = 0; j < 3; j++)
-		{
-			uint8_t dest = m_cornerIndicies[i][j];
-			uint8_t src = m_cornerIndicies[piece.piece][(j + 3 - piece.orientation) % 3];
-			CubeFace face = FACE_FOR_IDX(src);
-			m_state[dest] = m_state[IDX(face, 1, 1)];
-		}
+		const CubeColor* colors = Cube3x3::m_faceConversion.cornerColors[piece.piece][piece.orientation];
+		m_state[m_cornerIndicies[i][0]] = colors[0];
+		m_state[m_cornerIndicies[i][1]] = colors[1];
+		m_state[m_cornerIndicies[i][2]] = colors[2];
 	}
 
 	// Translate edge pieces into face colors
 	for (size_t i = 0; i < 12; i++)
 	{
 		const CubePiece& piece = cube.Edge((CubeEdge)i);
-		for (size_t j = 0; j < 2; j++)
-		{
-			uint8_t dest = m_edgeIndicies[i][j];
-			uint8_t src = m_edgeIndicies[piece.piece][j ^ piece.orientation];
-			CubeFace face = FACE_FOR_IDX(src);
-			m_state[dest] = m_state[IDX(face, 1, 1)];
-		}
+		const CubeColor* colors = Cube3x3::m_faceConversion.edgeColors[piece.piece][piece.orientation];
+		m_state[m_edgeIndicies[i][0]] = colors[0];
+		m_state[m_edgeIndicies[i][1]] = colors[1];
 	}
 }
 
@@ -1141,14 +2248,31 @@ void Cube3x3Faces::Rotate(CubeFace face, CubeRotationDirection dir)
 
 void Cube3x3Faces::Move(CubeMove move)
 {
-	MoveWithRotation(*this, move);
+	if (m_useAVX2)
+		MoveAVX2(*this, move);
+	else
+		m_moveKernels[move](*this);
+}
+
+
+void Cube3x3Faces::MoveScalar(CubeMove move)
+{
+	m_moveKernels[move](*this);
 }
 
 
 void Cube3x3Faces::Apply(const CubeMoveSequence& moves)
 {
-	for (auto i : moves.moves)
-		Move(i);
+	if (m_useAVX2)
+	{
+		for (auto i : moves.moves)
+			MoveAVX2(*this, i);
+	}
+	else
+	{
+		for (auto i : moves.moves)
+			m_moveKernels[i](*this);
+	}
 }
 
 
@@ -1177,6 +2301,14 @@ void Cube3x3Faces::SetColor(CubeFace face, uint8_t row, uint8_t col, CubeColor c
 
 
 bool Cube3x3Faces::IsSolved() const
+{
+	if (m_useAVX2)
+		return IsSolvedAVX2(*this);
+	return IsSolvedScalar();
+}
+
+
+bool Cube3x3Faces::IsSolvedScalar() const
 {
 	for (size_t i = 0; i < 6; i++)
 	{
@@ -1192,6 +2324,14 @@ bool Cube3x3Faces::IsSolved() const
 
 
 bool Cube3x3Faces::operator==(const Cube3x3Faces& cube) const
+{
+	if (m_useAVX2)
+		return EqualsAVX2(*this, cube);
+	return EqualsScalar(cube);
+}
+
+
+bool Cube3x3Faces::EqualsScalar(const Cube3x3Faces& cube) const
 {
 	for (size_t i = 0; i < 6 * 9; i++)
 	{
@@ -1263,13 +2403,31 @@ void Cube3x3Faces::PrintDebugState() const
 
 CubeMoveSequence Cube3x3RandomStateScramble::GetScramble(RandomSource& rng)
 {
-	CubeMoveSequence result;
-	while (true)
+	CancellationToken cancel;
+	return GetScramble(rng, cancel);
+}
+
+
+CubeMoveSequence Cube3x3RandomStateScramble::GetScramble(RandomSource& rng, const CancellationToken& cancel)
+{
+	// Every solve fails without the solver tables, so don't keep trying to find a scramble
+	if (!Cube3x3::LoadTables())
+		return CubeMoveSequence();
+
+	// Random states are drawn and solved in the index form used by the search, without going
+	// through the piece representation. The states are the same as from GenerateRandomState.
+	Cube3x3SearchState moves;
+	while (!cancel.IsCancelled())
 	{
-		Cube3x3 cube;
-		cube.GenerateRandomState(rng);
-		result = cube.Solve().Inverted();
-		if (result.moves.size() >= 4)
-			return result;
+		Cube3x3SolveLimits limits;
+		limits.deadline = chrono::steady_clock::now() + chrono::milliseconds(RANDOM_STATE_SCRAMBLE_TIME_LIMIT_MS);
+		limits.cancel = &cancel;
+		Cube3x3SearchLimitState limitState(limits);
+		Cube3x3::SearchIndexCube(moves, Cube3x3::GenerateRandomIndexCube(rng), true, 1, &limitState);
+		if (cancel.IsCancelled())
+			break;
+		if (moves.bestMoveCount >= 4)
+			return BestSolution(moves).Inverted();
 	}
+	return CubeMoveSequence();
 }
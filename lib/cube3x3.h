@@ -1,6 +1,10 @@
 #pragma once
 
 #include <stddef.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <utility>
 #include "cubecommon.h"
 #include "scramble.h"
 
@@ -8,8 +12,16 @@
 #define CORNER_PERMUTATION_INDEX_COUNT 40320 // 8!
 #define EDGE_ORIENTATION_INDEX_COUNT 2048 // 2**11e
 #define PHASE_2_EDGE_PERMUTATION_INDEX_COUNT 40320 // 8!
+#define EDGE_PERMUTATION_INDEX_COUNT 479001600 // 12!
 #define EDGE_SLICE_INDEX_COUNT 495 // NChooseK(12, 4)
 #define PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT 24 // 4!
+#define SORTED_EDGE_INDEX_COUNT 11880 // 12! / 8!
+#define PHASE_2_SORTED_EDGE_INDEX_COUNT 1680 // 8! / 4!
+#define UD_SYMMETRY_COUNT 16 // Symmetries of the cube that preserve the U/D axis
+#define FLIP_SLICE_SYM_INDEX_COUNT 64430 // Classes of EDGE_ORIENTATION_INDEX_COUNT * EDGE_SLICE_INDEX_COUNT under symmetry
+#define PHASE_1_PRUNE_INDEX_COUNT (FLIP_SLICE_SYM_INDEX_COUNT * CORNER_ORIENTATION_INDEX_COUNT)
+#define CORNER_PERMUTATION_SYM_INDEX_COUNT 2768 // Classes of CORNER_PERMUTATION_INDEX_COUNT under symmetry
+#define PHASE_2_PRUNE_INDEX_COUNT (CORNER_PERMUTATION_SYM_INDEX_COUNT * PHASE_2_EDGE_PERMUTATION_INDEX_COUNT)
 
 #define MAX_3x3_PHASE_1_MOVES 12
 #define MAX_3x3_PHASE_2_MOVES 18
@@ -17,6 +29,13 @@
 
 #define MIN_3X3_EFFICIENT_MOVES 18
 
+// States within this many moves of solved are stored in the endgame table, and optimal solves search
+// outwards from the cube state to meet the table for states up to the larger count.
+#define MAX_3X3_ENDGAME_TABLE_MOVES 5
+#define MAX_3X3_ENDGAME_SEARCH_MOVES 12
+#define ENDGAME_TABLE_BITS 20 // Table has 2**20 entries to hold the 621649 states with room to spare
+#define ENDGAME_TABLE_SIZE (1 << ENDGAME_TABLE_BITS)
+
 // A CubePiece is an identification of a piece (CubeCorner or CubeEdge)
 // and an orientation (flip or twist from solved state). A full cube state
 // can be represented as the pieces and orientations making up the cube
@@ -32,7 +51,72 @@ struct CubePiece
 };
 
 class Cube3x3Faces;
+class Cube3x3SolutionCache;
 struct Cube3x3SearchState;
+struct Cube3x3SearchLimitState;
+
+// Limits for an anytime solve. The search keeps looking for shorter solutions until a limit is
+// reached, then returns the best solution found so far. Limits are not applied until the first
+// solution has been found, so a valid solution is always returned.
+struct Cube3x3SolveLimits
+{
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+	uint64_t maxNodes = 0; // Zero for no node limit
+
+	// Stops the search as soon as the token is cancelled, even if no solution has been found yet. A
+	// cancelled solve returns an empty move sequence.
+	const CancellationToken* cancel = nullptr;
+
+	// Called each time a shorter solution is found. With multiple threads, this can be called
+	// from any of the search threads, but calls will not overlap.
+	std::function<void(const CubeMoveSequence& solution)> improvedFunc;
+};
+
+// Options for solving many cube states at once
+struct Cube3x3BatchSolveOptions
+{
+	bool optimal = true;
+	size_t threadCount = 0; // Zero will use all available cores
+
+	// The node limit and improvement callback apply to each solve, and the callback can be called
+	// from multiple threads at once. The deadline and cancellation token apply to the whole batch.
+	Cube3x3SolveLimits limits;
+
+	// Time allowed for each solve, counted from when that solve starts. Zero for no limit other
+	// than the batch deadline.
+	std::chrono::steady_clock::duration solveTimeLimit = std::chrono::steady_clock::duration::zero();
+};
+
+// Statistics about the work done by a solve, used for tuning the solver. Counting in the inner
+// loops of the search has a cost, so these are only collected when the library is built with
+// CUBE3X3_SOLVE_STATS defined. Otherwise all of the values are left at zero.
+struct Cube3x3SolveStats
+{
+	// Number of nodes expanded in each phase, indexed by the remaining search depth
+	uint64_t phase1Nodes[MAX_3X3_SOLUTION_MOVES + 1] = {};
+	uint64_t phase2Nodes[MAX_3X3_SOLUTION_MOVES + 1] = {};
+	uint64_t endgameNodes = 0;
+
+	// Number of branches cut by each of the prune tables
+	uint64_t phase1PruneCuts = 0;
+	uint64_t cornerPermutationAllMovesPruneCuts = 0;
+	uint64_t phase1CornerPermutationPruneCuts = 0;
+	uint64_t phase2SolvableCuts = 0;
+	uint64_t phase2PruneCuts = 0;
+	uint64_t cornerPermutationPruneCuts = 0;
+	uint64_t phase2EdgePermutationPruneCuts = 0;
+
+	// Number of phase 1 solutions that were searched for a phase 2 solution
+	uint64_t phase2Entries = 0;
+
+	// Time spent in each part of the search. Phase 1 time does not include time spent in phase 2.
+	std::chrono::steady_clock::duration phase1Time = std::chrono::steady_clock::duration::zero();
+	std::chrono::steady_clock::duration phase2Time = std::chrono::steady_clock::duration::zero();
+	std::chrono::steady_clock::duration endgameTime = std::chrono::steady_clock::duration::zero();
+
+	void Add(const Cube3x3SolveStats& other);
+	std::string ToString() const;
+};
 
 // Representation of a 3x3x3 cube using piece format
 class Cube3x3
@@ -40,30 +124,119 @@ class Cube3x3
 	CubePiece m_corners[8];
 	CubePiece m_edges[12];
 
-	static CubePiece m_cornerRotation[2][6][8];
-	static CubePiece m_edgeRotation[2][6][12];
-	static CubeColor m_cornerColors[8][3];
-	static CubeColor m_edgeColors[12][2];
+	static const CubePiece m_cornerRotation[2][6][8];
+	static const CubePiece m_edgeRotation[2][6][12];
+	static const CubeColor m_cornerColors[8][3];
+	static const CubeColor m_edgeColors[12][2];
+
+	// Tables for converting between piece and face color formats, generated at compile time from the
+	// piece colors above. The color tables give the colors of a piece in each orientation, in the same
+	// order as the piece colors. The piece tables give the piece and orientation for the colors on a
+	// corner or edge, indexed by the colors as base 6 digits.
+	struct FaceConversionTables
+	{
+		CubeColor cornerColors[8][3][3];
+		CubeColor edgeColors[12][2][2];
+		CubePiece cornerPieces[6 * 6 * 6];
+		CubePiece edgePieces[6 * 6];
+	};
+	static constexpr FaceConversionTables GetFaceConversionTables();
+	static const FaceConversionTables m_faceConversion;
+	friend class Cube3x3Faces;
+
+	// Tables for computing and setting coordinate indicies in linear time. The bit count of a mask of
+	// the pieces not yet seen gives the number of smaller pieces that are still remaining.
+	struct IndexTables
+	{
+		uint8_t bitCount[1 << 12];
+		int factorial[13];
+		int binomial[13][5];
+	};
+	static constexpr IndexTables GetIndexTables();
+	static const IndexTables m_indexTables;
+
+	static int GetPermutationIndex(const uint8_t* pieces, int count);
+	static void SetPermutationIndex(uint8_t* pieces, int count, int idx);
+	static int GetPermutationParity(int idx, int count);
+	static int GetCombinationIndex(const int* positions);
+	static int GetCombinationIndex(uint32_t mask);
+	static void SetCombinationIndex(int* positions, int idx);
+
+	// Effect of each move, precomposed at compile time from the rotation tables so that half turns
+	// are a single step. Each entry is where the piece comes from and the change in orientation.
+	struct MoveTable
+	{
+		CubePiece corners[8];
+		CubePiece edges[12];
+	};
+	static constexpr MoveTable GetMoveTable(CubeMove move);
+	static const MoveTable m_moveTables[MOVE_D2 + 1];
+
+	// Move functions specialized for each move, so that the tables above are folded into the code
+	// and only the pieces that move are touched
+	template <CubeMove move, size_t... i> static void MovePieces(Cube3x3& cube, std::index_sequence<i...>);
+	template <CubeMove move> static void MoveKernel(Cube3x3& cube);
+	static void (*const m_moveKernels[MOVE_D2 + 1])(Cube3x3& cube);
+
+	// The solver tables below are generated at runtime by Cube3x3TableGenerator and stored in a single
+	// block of memory, which is normally a memory mapped table file. SetTableData points each table at
+	// its location within the block and returns the total size of the block.
+	static size_t SetTableData(uint8_t* data);
+	friend class Cube3x3TableGenerator;
 
 	// These tables contain the effect of all moves on each type of index used to identify various asepcts of the
 	// cube's state. This is used during solving to quickly move between states using precomputed information.
-	// These are generated by tools/gentables3x3.cpp
-	static int m_cornerOrientationMoveTable[CORNER_ORIENTATION_INDEX_COUNT][MOVE_D2 + 1];
-	static int m_cornerPermutationMoveTable[CORNER_PERMUTATION_INDEX_COUNT][MOVE_D2 + 1];
-	static int m_edgeOrientationMoveTable[EDGE_ORIENTATION_INDEX_COUNT][MOVE_D2 + 1];
-	static int m_equatorialEdgeSliceMoveTable[EDGE_SLICE_INDEX_COUNT][MOVE_D2 + 1];
-	static int m_phase2EdgePermutationMoveTable[PHASE_2_EDGE_PERMUTATION_INDEX_COUNT][MOVE_D2 + 1];
-	static int m_phase2EquatorialEdgePermutationMoveTable[PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT][MOVE_D2 + 1];
+	// All moves for an index are stored together, as the search tries every move from the same state. Entries
+	// are 16 bits to keep as much of the tables in cache as possible.
+	static uint16_t (*m_cornerOrientationMoveTable)[MOVE_D2 + 1];
+	static uint16_t (*m_cornerPermutationMoveTable)[MOVE_D2 + 1];
+	static uint16_t (*m_edgeOrientationMoveTable)[MOVE_D2 + 1];
+	static uint16_t (*m_equatorialEdgeSliceMoveTable)[MOVE_D2 + 1];
+	static uint16_t (*m_phase2EdgePermutationMoveTable)[MOVE_D2 + 1];
+	static uint16_t (*m_phase2EquatorialEdgePermutationMoveTable)[MOVE_D2 + 1];
+	static uint16_t (*m_sortedEdgeMoveTable)[MOVE_D2 + 1];
+
+	// Table for combining the sorted edge indicies of the top and bottom edges into the phase 2 edge
+	// permutation index once phase 1 is solved. The first index is the sorted top edge index and the
+	// second is the order of the bottom edges (the positions are the ones not used by the top edges).
+	static uint16_t (*m_phase2EdgePermutationMergeTable)[PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT];
+
+	// These tables reduce the combined edge orientation and equatorial edge slice index using the symmetries
+	// of the cube that preserve the U/D axis. Each entry of the flip slice table is the symmetry class in the
+	// upper bits and the symmetry that maps the state onto the class representative in the lower 4 bits. The
+	// corner orientation table gives the corner orientation index after applying each symmetry.
+	static uint32_t (*m_flipSliceSymTable)[EDGE_SLICE_INDEX_COUNT];
+	static uint16_t (*m_cornerOrientationSymTable)[UD_SYMMETRY_COUNT];
+
+	// Same as above for phase 2, reducing the corner permutation by symmetry and applying the same
+	// symmetry to the phase 2 edge permutation.
+	static uint16_t* m_cornerPermutationSymTable;
+	static uint16_t (*m_phase2EdgePermutationSymTable)[UD_SYMMETRY_COUNT];
 
 	// These tables contain the minimum number of moves to solve given indicies that identify aspects of the
 	// cube's state. These can be used during solving to prune the search space if the current state cannot
-	// be solved in the desired number of moves. These are generated by tools/gentables3x3.cpp
-	static uint8_t m_cornerOrientationPruneTable[CORNER_ORIENTATION_INDEX_COUNT][EDGE_SLICE_INDEX_COUNT];
-	static uint8_t m_edgeOrientationPruneTable[EDGE_ORIENTATION_INDEX_COUNT][EDGE_SLICE_INDEX_COUNT];
-	static uint32_t m_combinedOrientationPruneTable[CORNER_ORIENTATION_INDEX_COUNT][EDGE_ORIENTATION_INDEX_COUNT / 8];
-	static uint8_t m_cornerPermutationPruneTable[CORNER_PERMUTATION_INDEX_COUNT][PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT];
-	static uint8_t m_phase2EdgePermutationPruneTable[PHASE_2_EDGE_PERMUTATION_INDEX_COUNT][PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT];
-	static uint8_t m_phase1CornerPermutationPruneTable[CORNER_PERMUTATION_INDEX_COUNT];
+	// be solved in the desired number of moves.
+	// The phase 1 table is indexed by flip slice symmetry class and corner orientation, and the phase 2
+	// table is indexed by corner permutation symmetry class and phase 2 edge permutation. These contain
+	// the move count modulo 3 packed into 2 bits per entry. The exact move count is tracked during the search.
+	static uint64_t* m_phase1PruneTable;
+	static uint64_t* m_phase2PruneTable;
+	static uint8_t (*m_cornerPermutationPruneTable)[PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT];
+	static uint8_t (*m_phase2EdgePermutationPruneTable)[PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT];
+	static uint8_t* m_phase1CornerPermutationPruneTable;
+	static uint8_t* m_cornerPermutationAllMovesPruneTable;
+
+	// Minimum number of moves to solve each group of four edges using all moves. The groups are the
+	// top, bottom, and equatorial edges, indexed by sorted edge index.
+	static uint8_t (*m_sortedEdgeAllMovesPruneTable)[SORTED_EDGE_INDEX_COUNT];
+
+	// Hash table of all states within MAX_3X3_ENDGAME_TABLE_MOVES of solved, using linear probing.
+	// Keys are the packed cube state from GetEndgameKey. Each entry contains the move count in the
+	// upper 3 bits and the next move towards solved in the lower 5 bits, or 0xff if empty.
+	static uint64_t* m_endgameKeys;
+	static uint8_t* m_endgameTable;
+
+	static std::atomic<Cube3x3SolutionCache*> m_solutionCache;
 
 	struct PossibleSearchMoves
 	{
@@ -86,6 +259,13 @@ class Cube3x3
 		int cornerPermutation;
 		int edgeOrientation;
 		int equatorialEdgeSlice;
+		int distance;
+
+		// Position and order of the equatorial, top, and bottom edges, used to find the phase 2
+		// edge permutation indicies without needing the full cube state
+		int sortedEquatorialEdges;
+		int sortedTopEdges;
+		int sortedBottomEdges;
 	};
 
 	struct Phase2IndexCube
@@ -93,11 +273,41 @@ class Cube3x3
 		int cornerPermutation;
 		int edgePermutation;
 		int equatorialEdgePermutation;
+		int distance;
 	};
 
+	static int GetMod3PruneValue(const uint64_t* table, size_t idx);
+	static int GetMod3PruneDistance(int parentDistance, int value);
+	static int GetPhase1PruneValue(const Phase1IndexCube& cube);
+	static int GetPhase1Distance(const Phase1IndexCube& cube);
+	static int GetPhase2PruneValue(const Phase2IndexCube& cube);
+	static bool IsPhase2Solvable(const Phase2IndexCube& cube, int maxMoves);
+	static int GetPhase2Distance(const Phase2IndexCube& cube, int maxMoves);
 	static void SearchPhase1(Cube3x3SearchState& moves, const Phase1IndexCube& cube, int depth);
 	static bool SearchPhase2(Cube3x3SearchState& moves, const Phase2IndexCube& cube, int depth);
 
+	static Phase1IndexCube MoveIndexCube(const Phase1IndexCube& cube, CubeMove move);
+	static uint64_t GetEndgameKey(const Phase1IndexCube& cube);
+	static int FindEndgameEntry(uint64_t key);
+	static int GetEndgameDistance(const Phase1IndexCube& cube);
+	static int GetEndgameSolution(const Phase1IndexCube& cube, CubeMove* solution);
+	static bool SearchEndgame(Cube3x3SearchState& moves, const Phase1IndexCube& cube, int depth);
+	static bool SearchEndgameToDepth(Cube3x3SearchState& moves, const Phase1IndexCube& cube, int maxMoves);
+	static void SearchPhase1Parallel(Cube3x3SearchState& moves, const Phase1IndexCube& cube, size_t threadCount);
+
+	void Search(Cube3x3SearchState& moves, bool optimal, size_t threadCount, Cube3x3SearchLimitState* limitState);
+	static void SearchIndexCube(Cube3x3SearchState& moves, Phase1IndexCube cube, bool optimal, size_t threadCount,
+		Cube3x3SearchLimitState* limitState);
+
+	// Draws a uniformly random solvable state directly as coordinates in the index form used by the
+	// search, with the edge permutation given by the sorted edge indicies. The distance is not set.
+	static Phase1IndexCube GenerateRandomIndexCube(RandomSource& rng);
+	void SetIndexCube(const Phase1IndexCube& cube);
+
+	friend class Cube3x3Solver;
+	friend class Cube3x3OptimalSolver;
+	friend class Cube3x3RandomStateScramble;
+
 public:
 	Cube3x3();
 	Cube3x3(const Cube3x3Faces& cube);
@@ -106,6 +316,9 @@ public:
 	void Move(CubeMove move);
 	void Apply(const CubeMoveSequence& moves);
 
+	// Generates a uniformly random solvable state. The coordinates for the corner and edge
+	// permutations and orientations are drawn directly, with the edge permutation drawn as the
+	// positions and order of each group of four edges, and its parity matched to the corners.
 	void GenerateRandomState(RandomSource& rng);
 
 	CubePiece& Corner(CubeCorner corner) { return m_corners[corner]; }
@@ -125,35 +338,140 @@ public:
 	int GetPhase2EdgePermutationIndex();
 	int GetEquatorialEdgeSliceIndex();
 	int GetPhase2EquatorialEdgePermutationIndex();
+	int GetSortedEdgeIndex(CubeEdge firstEdge);
+
+	// Sets the part of the cube state described by each index, leaving the rest of the state alone
+	// where possible. Setting the edge slice or sorted edge index places the remaining edges in the
+	// remaining positions in order, and the phase 2 edge indicies are only valid for phase 2 cubes,
+	// as with getting them. Parity is not adjusted, so the result may not be a solvable cube.
+	void SetCornerOrientationIndex(int idx);
+	void SetCornerPermutationIndex(int idx);
+	void SetEdgeOrientationIndex(int idx);
+	void SetPhase2EdgePermutationIndex(int idx);
+	void SetEquatorialEdgeSliceIndex(int idx);
+	void SetPhase2EquatorialEdgePermutationIndex(int idx);
+	void SetSortedEdgeIndex(CubeEdge firstEdge, int idx);
 
 	// Generates moves sequence that will solve the current cube state. If optimal is false, return
 	// the first found valid solution, which will be at most 30 moves, for a quicker result.
 	CubeMoveSequence Solve(bool optimal = true);
+
+	// Same as above, but the optimal search is split across the given number of threads (zero will
+	// use all available cores). The result is identical to the single threaded search.
+	CubeMoveSequence Solve(bool optimal, size_t threadCount);
+
+	// Sets a cache that is checked by the above solves before searching, and filled in with the
+	// results. Solves with limits are not cached, as their results depend on timing. Pass null to
+	// stop using the cache. The cache must remain valid while it is set.
+	static void SetSolutionCache(Cube3x3SolutionCache* cache);
+
+	// Optimal solve that stops early when the given limits are reached. Use this when a bounded
+	// solve time is more important than the shortest possible solution.
+	CubeMoveSequence Solve(const Cube3x3SolveLimits& limits, size_t threadCount = 1);
+
+	// Solves each of the given cube states, spreading them across a pool of threads. Each solve
+	// runs on a single thread. Solutions are returned in the same order as the input.
+	static std::vector<CubeMoveSequence> SolveBatch(const std::vector<Cube3x3>& cubes,
+		const Cube3x3BatchSolveOptions& options = Cube3x3BatchSolveOptions());
+
+	// The solver tables are memory mapped from the given file the first time they are needed. If the
+	// file is missing or invalid, the tables are generated and the file is written for next time. If
+	// no file is set, the tables are generated in memory.
+	static void SetTableFilePath(const std::string& path);
+
+	// Loads or generates the solver tables on a background thread, so that they are usually ready
+	// by the time the first solve is started.
+	static void PrepareTablesInBackground();
+
+	// Waits until the solver tables are ready. Returns false if they could not be loaded or generated,
+	// in which case solves will return an empty solution.
+	static bool LoadTables();
+
+	// Generates the solver tables and writes them to the given file
+	static bool GenerateTableFile(const std::string& path);
 };
 
 struct Cube3x3SearchState
 {
-	Cube3x3 initialState;
 	CubeMove moves[MAX_3X3_SOLUTION_MOVES];
 	int count;
-	CubeMoveSequence bestSolution;
+	CubeMove bestMoves[MAX_3X3_SOLUTION_MOVES];
+	int bestMoveCount;
 	bool optimal;
 	int maxMoves;
+
+	// When searching in parallel, each worker is given subtrees of the search that start with
+	// a fixed set of moves. The best solution is shared between workers so that all of them
+	// can prune using it. Ties are broken using the order that the serial search would have
+	// visited the subtrees in, so that the result does not depend on thread timing.
+	CubeMove fixedMoves[2];
+	int fixedMoveCount;
+	int order;
+	int bestOrder;
+	std::atomic<int>* sharedBest;
+
+	// Anytime solves count search nodes and periodically check the limits. Once stopped is set,
+	// the search unwinds and keeps the best solution found so far.
+	Cube3x3SearchLimitState* limitState;
+	uint64_t uncheckedNodes;
+	bool stopped;
+
+#ifdef CUBE3X3_SOLVE_STATS
+	Cube3x3SolveStats stats;
+#endif
+};
+
+// Solver that keeps its search state between solves. Use this when solving many cube states
+// on a single thread. Once the result sequence has grown to hold a solution, solving does not
+// allocate any memory (unless a callback is given in the limits).
+class Cube3x3Solver
+{
+	Cube3x3SearchState m_state;
+
+public:
+	void Solve(const Cube3x3& cube, CubeMoveSequence& result, bool optimal = true);
+	void Solve(const Cube3x3& cube, const Cube3x3SolveLimits& limits, CubeMoveSequence& result);
+
+	// Statistics for the last solve. These are all zero unless built with CUBE3X3_SOLVE_STATS.
+	Cube3x3SolveStats GetLastSolveStats() const;
 };
 
 // Representation of a 3x3x3 cube using face color format
 class Cube3x3Faces
 {
-	CubeColor m_state[6 * 9];
-
-	static uint8_t m_cornerAdjacency[6][4][2];
-	static uint8_t m_edgeAdjacency[6][4];
-	static uint8_t m_faceRotation[2][9];
-	static uint8_t m_edgeRotation[2][4];
-	static uint8_t m_cornerRotation[2][4];
+	// The state is padded to 64 bytes so that it fits in a pair of 256 bit registers. The padding
+	// is always zero.
+	alignas(32) CubeColor m_state[64];
+
+	static const uint8_t m_cornerAdjacency[6][4][2];
+	static const uint8_t m_edgeAdjacency[6][4];
+	static const uint8_t m_faceRotation[2][9];
+	static const uint8_t m_edgeRotation[2][4];
+	static const uint8_t m_cornerRotation[2][4];
 	static uint8_t m_cornerIndicies[8][3];
 	static uint8_t m_edgeIndicies[12][2];
 
+	// Effect of each move, precomposed at compile time from the rotation tables. Each entry is the
+	// index where the new color comes from.
+	struct MoveTable
+	{
+		uint8_t source[6 * 9];
+	};
+	static constexpr MoveTable GetMoveTable(CubeMove move);
+	static const MoveTable m_moveTables[MOVE_D2 + 1];
+
+	template <CubeMove move, size_t... i> static void MoveColors(Cube3x3Faces& cube, std::index_sequence<i...>);
+	template <CubeMove move> static void MoveKernel(Cube3x3Faces& cube);
+	static void (*const m_moveKernels[MOVE_D2 + 1])(Cube3x3Faces& cube);
+
+	// Vectorized versions of Move, IsSolved, and operator==, used when the CPU supports AVX2. These
+	// are in cube3x3facesavx2.cpp.
+	static const bool m_useAVX2;
+	static bool IsAVX2Supported();
+	static void MoveAVX2(Cube3x3Faces& cube, CubeMove move);
+	static bool IsSolvedAVX2(const Cube3x3Faces& cube);
+	static bool EqualsAVX2(const Cube3x3Faces& a, const Cube3x3Faces& b);
+
 public:
 	Cube3x3Faces();
 	Cube3x3Faces(const Cube3x3& cube);
@@ -172,6 +490,12 @@ public:
 	bool operator==(const Cube3x3Faces& cube) const;
 	bool operator!=(const Cube3x3Faces& cube) const;
 
+	// Scalar versions of Move, IsSolved, and operator==, which are used when the CPU does not
+	// support AVX2. These are public so that tests can check that both versions agree.
+	void MoveScalar(CubeMove move);
+	bool IsSolvedScalar() const;
+	bool EqualsScalar(const Cube3x3Faces& cube) const;
+
 	CubeMoveSequence Solve(bool optimal = true);
 
 	void PrintDebugState() const;
@@ -182,5 +506,6 @@ class Cube3x3RandomStateScramble: public Scrambler
 public:
 	virtual std::string GetName() override { return "3x3x3 random state"; }
 	virtual CubeMoveSequence GetScramble(RandomSource& rng) override;
+	virtual CubeMoveSequence GetScramble(RandomSource& rng, const CancellationToken& cancel) override;
 	virtual size_t GetMaxMoveCount() override { return MAX_3X3_SOLUTION_MOVES; }
 };
@@ -0,0 +1,96 @@
+#include "cube3x3cache.h"
+
+using namespace std;
+
+
+Cube3x3SolutionCache::Cube3x3SolutionCache(size_t capacity): m_capacity(capacity), m_hand(0),
+	m_hits(0), m_misses(0)
+{
+	if (m_capacity == 0)
+		m_capacity = 1;
+	m_entries.reserve(m_capacity);
+	m_index.reserve(m_capacity);
+}
+
+
+Cube3x3CacheKey Cube3x3SolutionCache::GetKey(const Cube3x3& cube, bool optimal)
+{
+	Cube3x3CacheKey key;
+	key.corners = optimal ? 1 : 0;
+	for (int i = 7; i >= 0; i--)
+	{
+		const CubePiece& corner = cube.Corner((CubeCorner)i);
+		key.corners = (key.corners << 5) | corner.piece | (corner.orientation << 3);
+	}
+	key.edges = 0;
+	for (int i = 11; i >= 0; i--)
+	{
+		const CubePiece& edge = cube.Edge((CubeEdge)i);
+		key.edges = (key.edges << 5) | edge.piece | (edge.orientation << 4);
+	}
+	return key;
+}
+
+
+bool Cube3x3SolutionCache::Find(const Cube3x3& cube, bool optimal, CubeMoveSequence& solution)
+{
+	Cube3x3CacheKey key = GetKey(cube, optimal);
+	lock_guard<mutex> lock(m_mutex);
+	auto i = m_index.find(key);
+	if (i == m_index.end())
+	{
+		m_misses.fetch_add(1, memory_order_relaxed);
+		return false;
+	}
+
+	Entry& entry = m_entries[i->second];
+	entry.referenced = true;
+	solution.moves.assign(entry.solution.moves.begin(), entry.solution.moves.end());
+	m_hits.fetch_add(1, memory_order_relaxed);
+	return true;
+}
+
+
+void Cube3x3SolutionCache::Insert(const Cube3x3& cube, bool optimal, const CubeMoveSequence& solution)
+{
+	Cube3x3CacheKey key = GetKey(cube, optimal);
+	lock_guard<mutex> lock(m_mutex);
+	auto existing = m_index.find(key);
+	if (existing != m_index.end())
+	{
+		m_entries[existing->second].solution = solution;
+		m_entries[existing->second].referenced = true;
+		return;
+	}
+
+	if (m_entries.size() < m_capacity)
+	{
+		m_index[key] = m_entries.size();
+		m_entries.push_back(Entry { key, solution, false });
+		return;
+	}
+
+	// Cache is full, advance the clock hand past recently used entries, giving each of them
+	// another chance, and replace the first entry that has not been used since the last pass
+	while (m_entries[m_hand].referenced)
+	{
+		m_entries[m_hand].referenced = false;
+		m_hand = (m_hand + 1) % m_entries.size();
+	}
+	Entry& entry = m_entries[m_hand];
+	m_index.erase(entry.key);
+	m_index[key] = m_hand;
+	entry.key = key;
+	entry.solution = solution;
+	entry.referenced = false;
+	m_hand = (m_hand + 1) % m_entries.size();
+}
+
+
+void Cube3x3SolutionCache::Clear()
+{
+	lock_guard<mutex> lock(m_mutex);
+	m_entries.clear();
+	m_index.clear();
+	m_hand = 0;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "cube3x3.h"
+
+// Cube state packed into 128 bits, along with the solve mode. Each corner is 5 bits (3 bits for
+// the piece and 2 for the twist) and each edge is 5 bits (4 bits for the piece and 1 for the flip).
+struct Cube3x3CacheKey
+{
+	uint64_t corners; // Solve mode is stored above the corners
+	uint64_t edges;
+
+	bool operator==(const Cube3x3CacheKey& other) const
+	{
+		return (corners == other.corners) && (edges == other.edges);
+	}
+};
+
+struct Cube3x3CacheKeyHash
+{
+	size_t operator()(const Cube3x3CacheKey& key) const
+	{
+		return (size_t)((((key.corners * 0x9e3779b97f4a7c15ULL) ^ key.edges) * 0xff51afd7ed558ccdULL) >> 32);
+	}
+};
+
+// Bounded cache of solutions, for states that are solved repeatedly, such as when solving each
+// step of a solve or resolving after a mis-turn. The cache can be used from multiple threads.
+// When full, entries are evicted using the CLOCK algorithm, which approximates least recently used
+// without needing to reorder entries on each lookup.
+class Cube3x3SolutionCache
+{
+	struct Entry
+	{
+		Cube3x3CacheKey key;
+		CubeMoveSequence solution;
+		bool referenced;
+	};
+
+	std::mutex m_mutex;
+	std::vector<Entry> m_entries;
+	std::unordered_map<Cube3x3CacheKey, size_t, Cube3x3CacheKeyHash> m_index;
+	size_t m_capacity;
+	size_t m_hand;
+	std::atomic<uint64_t> m_hits, m_misses;
+
+public:
+	Cube3x3SolutionCache(size_t capacity = 4096);
+
+	static Cube3x3CacheKey GetKey(const Cube3x3& cube, bool optimal);
+
+	bool Find(const Cube3x3& cube, bool optimal, CubeMoveSequence& solution);
+	void Insert(const Cube3x3& cube, bool optimal, const CubeMoveSequence& solution);
+	void Clear();
+
+	uint64_t GetHitCount() const { return m_hits.load(std::memory_order_relaxed); }
+	uint64_t GetMissCount() const { return m_misses.load(std::memory_order_relaxed); }
+};
@@ -0,0 +1,189 @@
+#include <string.h>
+#include "cube3x3.h"
+
+// AVX2 functions are compiled for AVX2 individually so that the rest of the library does not
+// require it. They are only called if the CPU supports AVX2.
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define CUBE3X3_FACES_AVX2
+#define AVX2_FUNCTION
+#include <intrin.h>
+#include <immintrin.h>
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CUBE3X3_FACES_AVX2
+#define AVX2_FUNCTION __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+
+#ifdef CUBE3X3_FACES_AVX2
+// Shuffle masks that move the colors of the 64 byte state, which is held in two registers. The
+// AVX2 byte shuffle only works within each 16 byte lane, so each of the four source lanes is
+// broadcast to a full register and shuffled separately. Mask bytes are the index within the source
+// lane, or have the upper bit set to write zero if the color comes from another lane.
+struct FacesShuffle
+{
+	alignas(32) uint8_t masks[2][4][32];
+
+	void Set(const uint8_t* source)
+	{
+		for (int reg = 0; reg < 2; reg++)
+		{
+			for (int lane = 0; lane < 4; lane++)
+			{
+				for (int i = 0; i < 32; i++)
+				{
+					int src = source[(reg * 32) + i];
+					masks[reg][lane][i] = ((src / 16) == lane) ? (src % 16) : 0x80;
+				}
+			}
+		}
+	}
+};
+
+class FacesShuffleTables
+{
+public:
+	FacesShuffle moves[MOVE_D2 + 1];
+
+	// Moves each color to the position of every color on the same face, for checking if solved
+	FacesShuffle centers;
+
+	FacesShuffleTables()
+	{
+		// Padding is never moved
+		uint8_t source[64];
+		for (int i = 0; i < 64; i++)
+			source[i] = i;
+
+		for (int i = 0; i <= MOVE_D2; i++)
+		{
+			// Apply the move to a state where each color is its own index to find the source of
+			// each color
+			Cube3x3Faces cube;
+			for (int j = 0; j < (6 * 9); j++)
+				cube.SetColor((CubeFace)(j / 9), (j / 3) % 3, j % 3, (CubeColor)j);
+			cube.Move((CubeMove)i);
+			for (int j = 0; j < (6 * 9); j++)
+				source[j] = cube.GetColor((CubeFace)(j / 9), (j / 3) % 3, j % 3);
+			moves[i].Set(source);
+		}
+
+		for (int i = 0; i < 64; i++)
+			source[i] = (i < (6 * 9)) ? (((i / 9) * 9) + 4) : i;
+		centers.Set(source);
+	}
+};
+
+static FacesShuffleTables g_facesShuffleTables;
+
+
+static inline AVX2_FUNCTION __m256i ShuffleFromLanes(const __m256i* lanes, const uint8_t (*masks)[32])
+{
+	__m256i result = _mm256_shuffle_epi8(lanes[0], _mm256_load_si256((const __m256i*)masks[0]));
+	for (int i = 1; i < 4; i++)
+		result = _mm256_or_si256(result, _mm256_shuffle_epi8(lanes[i], _mm256_load_si256((const __m256i*)masks[i])));
+	return result;
+}
+
+
+static inline AVX2_FUNCTION void Shuffle(const CubeColor* state, const FacesShuffle& shuffle, __m256i& lo, __m256i& hi)
+{
+	__m256i stateLo = _mm256_load_si256((const __m256i*)state);
+	__m256i stateHi = _mm256_load_si256((const __m256i*)(state + 32));
+	__m256i lanes[4];
+	lanes[0] = _mm256_permute2x128_si256(stateLo, stateLo, 0x00);
+	lanes[1] = _mm256_permute2x128_si256(stateLo, stateLo, 0x11);
+	lanes[2] = _mm256_permute2x128_si256(stateHi, stateHi, 0x00);
+	lanes[3] = _mm256_permute2x128_si256(stateHi, stateHi, 0x11);
+	lo = ShuffleFromLanes(lanes, shuffle.masks[0]);
+	hi = ShuffleFromLanes(lanes, shuffle.masks[1]);
+}
+
+
+static AVX2_FUNCTION bool EqualState(const CubeColor* a, __m256i lo, __m256i hi)
+{
+	__m256i equalLo = _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i*)a), lo);
+	__m256i equalHi = _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i*)(a + 32)), hi);
+	return _mm256_movemask_epi8(_mm256_and_si256(equalLo, equalHi)) == -1;
+}
+
+
+bool Cube3x3Faces::IsAVX2Supported()
+{
+#ifdef _MSC_VER
+	// AVX2 also needs the OS to save the 256 bit registers
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return false;
+	__cpuid(info, 1);
+	if ((info[2] & (1 << 27)) == 0)
+		return false;
+	if ((_xgetbv(0) & 6) != 6)
+		return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	// This can run during static initialization, before the CPU features would otherwise be ready
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+
+AVX2_FUNCTION void Cube3x3Faces::MoveAVX2(Cube3x3Faces& cube, CubeMove move)
+{
+	__m256i lo, hi;
+	Shuffle(cube.m_state, g_facesShuffleTables.moves[move], lo, hi);
+	_mm256_store_si256((__m256i*)cube.m_state, lo);
+	_mm256_store_si256((__m256i*)(cube.m_state + 32), hi);
+}
+
+
+AVX2_FUNCTION bool Cube3x3Faces::IsSolvedAVX2(const Cube3x3Faces& cube)
+{
+	__m256i lo, hi;
+	Shuffle(cube.m_state, g_facesShuffleTables.centers, lo, hi);
+	return EqualState(cube.m_state, lo, hi);
+}
+
+
+AVX2_FUNCTION bool Cube3x3Faces::EqualsAVX2(const Cube3x3Faces& a, const Cube3x3Faces& b)
+{
+	__m256i lo = _mm256_load_si256((const __m256i*)b.m_state);
+	__m256i hi = _mm256_load_si256((const __m256i*)(b.m_state + 32));
+	return EqualState(a.m_state, lo, hi);
+}
+
+
+// Defined after the shuffle tables so that they are ready before the AVX2 functions are used
+const bool Cube3x3Faces::m_useAVX2 = Cube3x3Faces::IsAVX2Supported();
+#else
+bool Cube3x3Faces::IsAVX2Supported()
+{
+	return false;
+}
+
+
+void Cube3x3Faces::MoveAVX2(Cube3x3Faces& cube, CubeMove move)
+{
+	m_moveKernels[move](cube);
+}
+
+
+bool Cube3x3Faces::IsSolvedAVX2(const Cube3x3Faces& cube)
+{
+	return cube.IsSolved();
+}
+
+
+bool Cube3x3Faces::EqualsAVX2(const Cube3x3Faces& a, const Cube3x3Faces& b)
+{
+	return a == b;
+}
+
+
+const bool Cube3x3Faces::m_useAVX2 = false;
+#endif
@@ -0,0 +1,262 @@
+#include <string.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include "cube3x3optimal.h"
+
+// Searches shallower than this are run on a single thread
+#define OPTIMAL_PARALLEL_SEARCH_MIN_DEPTH 8
+
+// Number of search nodes between checks for cancellation
+#define OPTIMAL_SEARCH_CHECK_INTERVAL 4096
+
+using namespace std;
+
+
+int Cube3x3OptimalSolver::GetEdgeGroupIndex(const Cube3x3& cube, int firstEdge)
+{
+	// Find the positions and orientations of the three edges in the group
+	int positions[3];
+	int orientation = 0;
+	for (int i = 0; i < 12; i++)
+	{
+		const CubePiece& edge = cube.Edge((CubeEdge)i);
+		int groupIdx = (int)edge.piece - firstEdge;
+		if ((groupIdx < 0) || (groupIdx >= 3))
+			continue;
+		positions[groupIdx] = i;
+		orientation |= edge.orientation << (2 - groupIdx);
+	}
+
+	// Index of the positions is the index of the choice in the remaining possible positions
+	// for each edge, in the same way as the permutation indicies
+	int second = positions[1] - ((positions[1] > positions[0]) ? 1 : 0);
+	int third = positions[2] - ((positions[2] > positions[0]) ? 1 : 0) - ((positions[2] > positions[1]) ? 1 : 0);
+	return (((((positions[0] * 11) + second) * 10) + third) * 8) + orientation;
+}
+
+
+void Cube3x3OptimalSolver::SetEdgeGroupIndex(Cube3x3& cube, int firstEdge, int idx)
+{
+	// Edges in the group are placed at the positions from the index, and the other edges are
+	// placed in the remaining positions in order, without any flips
+	int orientation = idx % 8;
+	int choices[3] = {idx / (8 * 110), (idx / (8 * 10)) % 11, (idx / 8) % 10};
+	uint32_t used = 0;
+	for (int i = 0; i < 3; i++)
+	{
+		int pos = 0;
+		for (int choice = choices[i]; (used & (1 << pos)) || (choice > 0); pos++)
+		{
+			if ((used & (1 << pos)) == 0)
+				choice--;
+		}
+		cube.Edge((CubeEdge)pos) = CubePiece { (uint8_t)(firstEdge + i), (uint8_t)((orientation >> (2 - i)) & 1) };
+		used |= 1 << pos;
+	}
+
+	uint8_t otherPiece = 0;
+	for (int i = 0; i < 12; i++)
+	{
+		if (used & (1 << i))
+			continue;
+		if (otherPiece == firstEdge)
+			otherPiece += 3;
+		cube.Edge((CubeEdge)i) = CubePiece { otherPiece++, 0 };
+	}
+}
+
+
+size_t Cube3x3OptimalSolver::GetEdgePruneIndex(int firstGroup, int secondGroup)
+{
+	return ((size_t)m_edgeGroupMergeTable[firstGroup / 8][secondGroup / 8] * 64) +
+		((firstGroup % 8) * 8) + (secondGroup % 8);
+}
+
+
+static inline int GetPruneValue(const uint8_t* table, size_t idx)
+{
+	return (table[idx / 2] >> (4 * (idx % 2))) & 0xf;
+}
+
+
+int Cube3x3OptimalSolver::GetDistance(const IndexCube& cube)
+{
+	// Each pattern database gives the exact number of moves to solve part of the cube, so
+	// the largest of them is a lower bound for solving the whole cube
+	int corners = GetPruneValue(m_cornerPruneTable,
+		((size_t)cube.cornerPermutation * CORNER_ORIENTATION_INDEX_COUNT) + cube.cornerOrientation);
+	int firstEdges = GetPruneValue(m_edgePruneTables[0], GetEdgePruneIndex(cube.edgeGroups[0], cube.edgeGroups[1]));
+	int lastEdges = GetPruneValue(m_edgePruneTables[1], GetEdgePruneIndex(cube.edgeGroups[2], cube.edgeGroups[3]));
+	return max(corners, max(firstEdges, lastEdges));
+}
+
+
+bool Cube3x3OptimalSolver::Search(Cube3x3OptimalSearchState& state, const IndexCube& cube, int depth)
+{
+	// Only the solved state has a distance of zero in all of the pattern databases
+	int distance = GetDistance(cube);
+	if (distance == 0)
+		return true;
+	if (distance > depth)
+		return false;
+
+	if (++state.uncheckedNodes >= OPTIMAL_SEARCH_CHECK_INTERVAL)
+	{
+		state.uncheckedNodes = 0;
+		if (state.cancel && state.cancel->IsCancelled())
+			state.stopped = true;
+		if (state.sharedFoundOrder && (state.sharedFoundOrder->load(memory_order_relaxed) < state.order))
+			state.stopped = true;
+		if (state.stopped)
+			return false;
+	}
+
+	// Try every move, skipping moves that are redundant after the previous move
+	int moveIdx = state.count++;
+	const Cube3x3::PossibleSearchMoves* possibleMoves;
+	if (moveIdx == 0)
+		possibleMoves = &Cube3x3::m_possiblePhase1Moves;
+	else
+		possibleMoves = &Cube3x3::m_possiblePhase1FollowupMoves[state.moves[moveIdx - 1]];
+	for (int i = 0; i < possibleMoves->count; i++)
+	{
+		CubeMove move = possibleMoves->moves[i];
+		if ((moveIdx < state.fixedMoveCount) && (move != state.fixedMoves[moveIdx]))
+			continue;
+		state.moves[moveIdx] = move;
+
+		IndexCube newCube;
+		newCube.cornerPermutation = m_cornerPermutationMoveTable[cube.cornerPermutation][move];
+		newCube.cornerOrientation = m_cornerOrientationMoveTable[cube.cornerOrientation][move];
+		for (int j = 0; j < 4; j++)
+			newCube.edgeGroups[j] = m_edgeGroupMoveTable[cube.edgeGroups[j]][move];
+		if (Search(state, newCube, depth - 1))
+			return true;
+		if (state.stopped)
+			break;
+	}
+	state.count--;
+	return false;
+}
+
+
+void Cube3x3OptimalSolver::SearchParallel(Cube3x3OptimalSearchState& state, const IndexCube& cube,
+	int depth, size_t threadCount)
+{
+	// Split the search into subtrees by the first two moves. These are ordered in the same way
+	// that the serial search would visit them.
+	vector<pair<CubeMove, CubeMove>> subtrees;
+	for (int i = 0; i < Cube3x3::m_possiblePhase1Moves.count; i++)
+	{
+		CubeMove first = Cube3x3::m_possiblePhase1Moves.moves[i];
+		const Cube3x3::PossibleSearchMoves& followup = Cube3x3::m_possiblePhase1FollowupMoves[first];
+		for (int j = 0; j < followup.count; j++)
+			subtrees.push_back(pair<CubeMove, CubeMove>(first, followup.moves[j]));
+	}
+
+	atomic<int> sharedFoundOrder((int)subtrees.size());
+	atomic<size_t> nextSubtree(0);
+	vector<Cube3x3OptimalSearchState> workerStates(threadCount, state);
+	vector<thread> workers;
+	for (size_t i = 0; i < threadCount; i++)
+	{
+		workerStates[i].sharedFoundOrder = &sharedFoundOrder;
+		workerStates[i].fixedMoveCount = 2;
+		workers.push_back(thread([&, i]() {
+			Cube3x3OptimalSearchState& workerState = workerStates[i];
+			while (true)
+			{
+				size_t subtreeIdx = nextSubtree.fetch_add(1);
+				if (subtreeIdx >= subtrees.size())
+					break;
+				if ((int)subtreeIdx > sharedFoundOrder.load(memory_order_relaxed))
+					break;
+
+				workerState.count = 0;
+				workerState.order = (int)subtreeIdx;
+				workerState.fixedMoves[0] = subtrees[subtreeIdx].first;
+				workerState.fixedMoves[1] = subtrees[subtreeIdx].second;
+				workerState.stopped = false;
+				if (Search(workerState, cube, depth))
+				{
+					int found = sharedFoundOrder.load(memory_order_relaxed);
+					while ((workerState.order < found) &&
+						!sharedFoundOrder.compare_exchange_weak(found, workerState.order));
+					break;
+				}
+				if (state.cancel && state.cancel->IsCancelled())
+					break;
+			}
+		}));
+	}
+	for (auto& i : workers)
+		i.join();
+
+	// Keep the solution from the earliest subtree, which is the one the serial search would find
+	state.count = 0;
+	state.stopped = state.cancel && state.cancel->IsCancelled();
+	int found = sharedFoundOrder.load();
+	for (auto& i : workerStates)
+	{
+		if ((i.order == found) && (i.count != 0))
+		{
+			memcpy(state.moves, i.moves, sizeof(CubeMove) * i.count);
+			state.count = i.count;
+		}
+	}
+}
+
+
+CubeMoveSequence Cube3x3OptimalSolver::Solve(const Cube3x3& cube, size_t threadCount,
+	const CancellationToken* cancel)
+{
+	if (cube.IsSolved())
+		return CubeMoveSequence();
+	if (!LoadTables())
+		return CubeMoveSequence();
+
+	if (threadCount == 0)
+		threadCount = max(thread::hardware_concurrency(), 1u);
+
+	Cube3x3 copy = cube;
+	IndexCube indexCube;
+	indexCube.cornerPermutation = copy.GetCornerPermutationIndex();
+	indexCube.cornerOrientation = copy.GetCornerOrientationIndex();
+	for (int i = 0; i < 4; i++)
+		indexCube.edgeGroups[i] = GetEdgeGroupIndex(cube, i * 3);
+
+	Cube3x3OptimalSearchState state;
+	state.fixedMoveCount = 0;
+	state.order = 0;
+	state.sharedFoundOrder = nullptr;
+	state.cancel = cancel;
+	state.uncheckedNodes = 0;
+	state.stopped = false;
+
+	// Iterative deepening, so the first solution found is an optimal one
+	for (int depth = GetDistance(indexCube); depth <= MAX_3X3_OPTIMAL_MOVES; depth++)
+	{
+		state.count = 0;
+		bool found;
+		if ((threadCount > 1) && (depth >= OPTIMAL_PARALLEL_SEARCH_MIN_DEPTH))
+		{
+			SearchParallel(state, indexCube, depth, threadCount);
+			found = state.count != 0;
+		}
+		else
+		{
+			found = Search(state, indexCube, depth);
+		}
+
+		if (state.stopped)
+			break;
+		if (found)
+		{
+			CubeMoveSequence result;
+			result.moves.assign(&state.moves[0], &state.moves[state.count]);
+			return result;
+		}
+	}
+	return CubeMoveSequence();
+}
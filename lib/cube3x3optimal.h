@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include "cube3x3.h"
+
+#define EDGE_GROUP_POSITION_INDEX_COUNT 1320 // 12! / 9!
+#define EDGE_GROUP_INDEX_COUNT (EDGE_GROUP_POSITION_INDEX_COUNT * 8) // Three edges with 2**3 orientations
+#define EDGE_HALF_POSITION_INDEX_COUNT 665280 // 12! / 6!
+#define EDGE_HALF_PRUNE_INDEX_COUNT (EDGE_HALF_POSITION_INDEX_COUNT * 64) // Six edges with 2**6 orientations
+#define CORNER_PRUNE_INDEX_COUNT (CORNER_PERMUTATION_INDEX_COUNT * CORNER_ORIENTATION_INDEX_COUNT)
+
+#define MAX_3X3_OPTIMAL_MOVES 20
+
+struct Cube3x3OptimalSearchState;
+
+// Solver that always finds a solution with the fewest possible moves, using iterative deepening A*
+// over all moves (Korf's algorithm). The search is pruned using pattern databases for all of the
+// corners and for each half of the edges. This is much slower than the two phase solver and its
+// tables are much larger, so use it only when a guaranteed optimal solution is needed.
+class Cube3x3OptimalSolver
+{
+	// The solver tables below are generated at runtime by Cube3x3OptimalTableGenerator and stored in
+	// a single block of memory, in the same way as the two phase solver tables.
+	static size_t SetTableData(uint8_t* data);
+	friend class Cube3x3OptimalTableGenerator;
+
+	// Move tables for each coordinate. Edges are tracked in four groups of three edges, where each
+	// group index is the positions and orientations of three consecutive edges. All groups share
+	// the same move table.
+	static uint16_t (*m_cornerPermutationMoveTable)[MOVE_D2 + 1];
+	static uint16_t (*m_cornerOrientationMoveTable)[MOVE_D2 + 1];
+	static uint16_t (*m_edgeGroupMoveTable)[MOVE_D2 + 1];
+
+	// Combines the positions of two edge groups into the positions of six edges. Entries for groups
+	// that overlap are not valid.
+	static uint32_t (*m_edgeGroupMergeTable)[EDGE_GROUP_POSITION_INDEX_COUNT];
+
+	// Pattern databases containing the exact number of moves to solve the corners, the first six
+	// edges, and the last six edges. Entries are 4 bits each, with two entries per byte.
+	static uint8_t* m_cornerPruneTable;
+	static uint8_t* m_edgePruneTables[2];
+
+	struct IndexCube
+	{
+		uint16_t cornerPermutation;
+		uint16_t cornerOrientation;
+		uint16_t edgeGroups[4];
+	};
+
+	static int GetEdgeGroupIndex(const Cube3x3& cube, int firstEdge);
+	static void SetEdgeGroupIndex(Cube3x3& cube, int firstEdge, int idx);
+	static size_t GetEdgePruneIndex(int firstGroup, int secondGroup);
+	static int GetDistance(const IndexCube& cube);
+	static bool Search(Cube3x3OptimalSearchState& state, const IndexCube& cube, int depth);
+	static void SearchParallel(Cube3x3OptimalSearchState& state, const IndexCube& cube, int depth,
+		size_t threadCount);
+
+public:
+	// Returns a solution with the fewest possible moves. Random states can take a long time to
+	// solve, so the search can be stopped with the cancellation token, in which case an empty
+	// solution is returned. A thread count of zero will use all available cores.
+	static CubeMoveSequence Solve(const Cube3x3& cube, size_t threadCount = 0,
+		const CancellationToken* cancel = nullptr);
+
+	// The tables are memory mapped from the given file the first time they are needed, and are
+	// generated and written to the file if it is missing or invalid. These work in the same way as
+	// the two phase solver tables, but are kept in a separate file as they are only needed for
+	// optimal solves.
+	static void SetTableFilePath(const std::string& path);
+	static bool LoadTables();
+	static bool GenerateTableFile(const std::string& path);
+};
+
+struct Cube3x3OptimalSearchState
+{
+	CubeMove moves[MAX_3X3_OPTIMAL_MOVES];
+	int count;
+
+	// When searching in parallel, each worker is given subtrees that start with a fixed set of
+	// moves. Workers skip subtrees that come after the first one found to contain a solution, so
+	// that the result is the same as the serial search.
+	CubeMove fixedMoves[2];
+	int fixedMoveCount;
+	int order;
+	std::atomic<int>* sharedFoundOrder;
+
+	const CancellationToken* cancel;
+	uint64_t uncheckedNodes;
+	bool stopped;
+};
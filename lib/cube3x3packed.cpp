@@ -0,0 +1,190 @@
+#include <string.h>
+#include "cube3x3packed.h"
+
+// The SSSE3 move is compiled for SSSE3 individually so that the rest of the library does not
+// require it. It is only called if the CPU supports SSSE3.
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define CUBE3X3_PACKED_SSSE3
+#define SSSE3_FUNCTION
+#include <intrin.h>
+#include <tmmintrin.h>
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CUBE3X3_PACKED_SSSE3
+#define SSSE3_FUNCTION __attribute__((target("ssse3")))
+#include <tmmintrin.h>
+#endif
+
+using namespace std;
+
+
+// Shuffle and orientation change for each move. Shuffle indicies for unused bytes have the
+// upper bit set, which makes pshufb write zero.
+struct PackedMoveTable
+{
+	alignas(16) uint8_t cornerShuffle[16];
+	alignas(16) uint8_t cornerTwist[16];
+	alignas(16) uint8_t edgeShuffle[16];
+	alignas(16) uint8_t edgeFlip[16];
+};
+
+class PackedMoveTables
+{
+public:
+	PackedMoveTable moves[MOVE_D2 + 1];
+
+	PackedMoveTables()
+	{
+		// Apply each move to a solved cube. Each position then holds the piece that the move brings
+		// into that position, along with the orientation change from the move.
+		for (int i = 0; i <= MOVE_D2; i++)
+		{
+			Cube3x3 cube;
+			cube.Move((CubeMove)i);
+			PackedMoveTable& table = moves[i];
+			memset(&table, 0, sizeof(table));
+			memset(table.cornerShuffle, 0x80, sizeof(table.cornerShuffle));
+			memset(table.edgeShuffle, 0x80, sizeof(table.edgeShuffle));
+			for (int j = 0; j < 8; j++)
+			{
+				table.cornerShuffle[j] = cube.Corner((CubeCorner)j).piece;
+				table.cornerTwist[j] = cube.Corner((CubeCorner)j).orientation << 4;
+			}
+			for (int j = 0; j < 12; j++)
+			{
+				table.edgeShuffle[j] = cube.Edge((CubeEdge)j).piece;
+				table.edgeFlip[j] = cube.Edge((CubeEdge)j).orientation << 4;
+			}
+		}
+	}
+};
+
+static PackedMoveTables g_packedMoveTables;
+
+
+#ifdef CUBE3X3_PACKED_SSSE3
+static bool IsSSSE3Supported()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 1);
+	return (info[2] & (1 << 9)) != 0;
+#else
+	// This runs during static initialization, before the CPU features would otherwise be ready
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("ssse3");
+#endif
+}
+
+
+static const bool g_packedUseSSSE3 = IsSSSE3Supported();
+
+
+static SSSE3_FUNCTION void MoveSSSE3(uint8_t* cornerState, uint8_t* edgeState, const PackedMoveTable& table)
+{
+	__m128i corners = _mm_load_si128((const __m128i*)cornerState);
+	__m128i edges = _mm_load_si128((const __m128i*)edgeState);
+
+	// Move the corners into place and add the twist. Twists of 3 or more wrap around, which is
+	// done by subtracting 3 and keeping the smaller value. When the twist is less than 3, the
+	// subtraction wraps to a large value and the original value is kept.
+	corners = _mm_shuffle_epi8(corners, _mm_load_si128((const __m128i*)table.cornerShuffle));
+	corners = _mm_add_epi8(corners, _mm_load_si128((const __m128i*)table.cornerTwist));
+	corners = _mm_min_epu8(corners, _mm_sub_epi8(corners, _mm_set1_epi8(0x30)));
+
+	edges = _mm_shuffle_epi8(edges, _mm_load_si128((const __m128i*)table.edgeShuffle));
+	edges = _mm_xor_si128(edges, _mm_load_si128((const __m128i*)table.edgeFlip));
+
+	_mm_store_si128((__m128i*)cornerState, corners);
+	_mm_store_si128((__m128i*)edgeState, edges);
+}
+#endif
+
+
+Cube3x3Packed::Cube3x3Packed()
+{
+	memset(m_corners, 0, sizeof(m_corners));
+	memset(m_edges, 0, sizeof(m_edges));
+	for (int i = 0; i < 8; i++)
+		m_corners[i] = i;
+	for (int i = 0; i < 12; i++)
+		m_edges[i] = i;
+}
+
+
+Cube3x3Packed::Cube3x3Packed(const Cube3x3& cube)
+{
+	memset(m_corners, 0, sizeof(m_corners));
+	memset(m_edges, 0, sizeof(m_edges));
+	for (int i = 0; i < 8; i++)
+	{
+		const CubePiece& corner = cube.Corner((CubeCorner)i);
+		m_corners[i] = corner.piece | (corner.orientation << 4);
+	}
+	for (int i = 0; i < 12; i++)
+	{
+		const CubePiece& edge = cube.Edge((CubeEdge)i);
+		m_edges[i] = edge.piece | (edge.orientation << 4);
+	}
+}
+
+
+void Cube3x3Packed::Move(CubeMove move)
+{
+	const PackedMoveTable& table = g_packedMoveTables.moves[move];
+#ifdef CUBE3X3_PACKED_SSSE3
+	if (g_packedUseSSSE3)
+	{
+		MoveSSSE3(m_corners, m_edges, table);
+		return;
+	}
+#endif
+
+	uint8_t oldCorners[8];
+	uint8_t oldEdges[12];
+	memcpy(oldCorners, m_corners, sizeof(oldCorners));
+	memcpy(oldEdges, m_edges, sizeof(oldEdges));
+	for (int i = 0; i < 8; i++)
+	{
+		uint8_t corner = oldCorners[table.cornerShuffle[i]] + table.cornerTwist[i];
+		m_corners[i] = (corner >= 0x30) ? (corner - 0x30) : corner;
+	}
+	for (int i = 0; i < 12; i++)
+		m_edges[i] = oldEdges[table.edgeShuffle[i]] ^ table.edgeFlip[i];
+}
+
+
+void Cube3x3Packed::Apply(const CubeMoveSequence& moves)
+{
+	for (auto i : moves.moves)
+		Move(i);
+}
+
+
+bool Cube3x3Packed::IsSolved() const
+{
+	return *this == Cube3x3Packed();
+}
+
+
+bool Cube3x3Packed::operator==(const Cube3x3Packed& cube) const
+{
+	return (memcmp(m_corners, cube.m_corners, sizeof(m_corners)) == 0) &&
+		(memcmp(m_edges, cube.m_edges, sizeof(m_edges)) == 0);
+}
+
+
+bool Cube3x3Packed::operator!=(const Cube3x3Packed& cube) const
+{
+	return !(*this == cube);
+}
+
+
+Cube3x3 Cube3x3Packed::ToCube3x3() const
+{
+	Cube3x3 result;
+	for (int i = 0; i < 8; i++)
+		result.Corner((CubeCorner)i) = CubePiece { (uint8_t)(m_corners[i] & 0xf), (uint8_t)(m_corners[i] >> 4) };
+	for (int i = 0; i < 12; i++)
+		result.Edge((CubeEdge)i) = CubePiece { (uint8_t)(m_edges[i] & 0xf), (uint8_t)(m_edges[i] >> 4) };
+	return result;
+}
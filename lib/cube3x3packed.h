@@ -0,0 +1,31 @@
+#pragma once
+
+#include "cube3x3.h"
+
+// Representation of a 3x3x3 cube in piece format, packed so that each move is a byte shuffle. Each
+// piece is a byte with the piece in the low 4 bits and the orientation in the upper bits. The 8
+// corners and 12 edges do not fit in a single 16 byte register, so the corners and edges are each
+// kept in their own 16 byte block with the unused bytes set to zero.
+//
+// When the CPU supports SSSE3, each move is a pshufb of each block followed by adding the corner
+// twist or flipping the edges. Otherwise an equivalent byte loop is used. This is faster than
+// Cube3x3 for applying large numbers of moves, but does not have any of the solver features.
+class Cube3x3Packed
+{
+	alignas(16) uint8_t m_corners[16];
+	alignas(16) uint8_t m_edges[16];
+
+public:
+	Cube3x3Packed();
+	Cube3x3Packed(const Cube3x3& cube);
+
+	void Move(CubeMove move);
+	void Apply(const CubeMoveSequence& moves);
+
+	bool IsSolved() const;
+	bool operator==(const Cube3x3Packed& cube) const;
+	bool operator!=(const Cube3x3Packed& cube) const;
+
+	// Converts back to the normal piece format. Conversion is lossless in both directions.
+	Cube3x3 ToCube3x3() const;
+};
@@ -0,0 +1,1396 @@
+#include <string.h>
+#include <stdio.h>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include "cube3x3.h"
+#include "cube3x3optimal.h"
+
+// Version of the table file. This must be incremented whenever the layout or contents of the
+// tables change, so that table files written by older versions are regenerated.
+#define TABLE_FILE_VERSION 3
+#define OPTIMAL_TABLE_FILE_VERSION 1
+#define TABLE_FILE_BYTE_ORDER 0x01020304
+
+// Each table starts on a cache line boundary within the table data
+#define TABLE_ALIGNMENT 64
+
+// Marks table entries that have not been filled in yet during generation
+#define UNKNOWN_INDEX 0xffff
+#define UNKNOWN_DISTANCE 0xff
+
+// Number of coordinate indicies handled at once by each thread while generating tables
+#define TABLE_SEARCH_CHUNK_SIZE 65536
+
+using namespace std;
+
+
+// The table file is this header followed by the table data. The checksum covers the table data. It
+// is only verified after the file is written, as reading every page of the tables when loading would
+// defeat mapping the file lazily. Loading checks the rest of the header and the file size.
+struct TableFileHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t byteOrder;
+	uint64_t dataSize;
+	uint64_t checksum;
+	uint8_t reserved[32];
+};
+
+static_assert(sizeof(TableFileHeader) == TABLE_ALIGNMENT, "Table file header must keep table data aligned");
+
+static const char g_tableFileMagic[8] = {'T', 'P', 'S', 'C', 'U', 'B', 'E', '3'};
+static const char g_optimalTableFileMagic[8] = {'T', 'P', 'S', 'O', 'P', 'T', 'M', '3'};
+
+static mutex g_tableMutex;
+static atomic<bool> g_tablesReady(false);
+static bool g_tablesFailed = false;
+static string g_tableFilePath;
+
+static mutex g_optimalTableMutex;
+static atomic<bool> g_optimalTablesReady(false);
+static bool g_optimalTablesFailed = false;
+static string g_optimalTableFilePath;
+
+uint16_t (*Cube3x3::m_cornerOrientationMoveTable)[MOVE_D2 + 1];
+uint16_t (*Cube3x3::m_cornerPermutationMoveTable)[MOVE_D2 + 1];
+uint16_t (*Cube3x3::m_edgeOrientationMoveTable)[MOVE_D2 + 1];
+uint16_t (*Cube3x3::m_equatorialEdgeSliceMoveTable)[MOVE_D2 + 1];
+uint16_t (*Cube3x3::m_phase2EdgePermutationMoveTable)[MOVE_D2 + 1];
+uint16_t (*Cube3x3::m_phase2EquatorialEdgePermutationMoveTable)[MOVE_D2 + 1];
+uint16_t (*Cube3x3::m_sortedEdgeMoveTable)[MOVE_D2 + 1];
+uint16_t (*Cube3x3::m_phase2EdgePermutationMergeTable)[PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT];
+uint32_t (*Cube3x3::m_flipSliceSymTable)[EDGE_SLICE_INDEX_COUNT];
+uint16_t (*Cube3x3::m_cornerOrientationSymTable)[UD_SYMMETRY_COUNT];
+uint16_t* Cube3x3::m_cornerPermutationSymTable;
+uint16_t (*Cube3x3::m_phase2EdgePermutationSymTable)[UD_SYMMETRY_COUNT];
+uint64_t* Cube3x3::m_phase1PruneTable;
+uint64_t* Cube3x3::m_phase2PruneTable;
+uint8_t (*Cube3x3::m_cornerPermutationPruneTable)[PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT];
+uint8_t (*Cube3x3::m_phase2EdgePermutationPruneTable)[PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT];
+uint8_t* Cube3x3::m_phase1CornerPermutationPruneTable;
+uint8_t* Cube3x3::m_cornerPermutationAllMovesPruneTable;
+uint8_t (*Cube3x3::m_sortedEdgeAllMovesPruneTable)[SORTED_EDGE_INDEX_COUNT];
+uint64_t* Cube3x3::m_endgameKeys;
+uint8_t* Cube3x3::m_endgameTable;
+
+uint16_t (*Cube3x3OptimalSolver::m_cornerPermutationMoveTable)[MOVE_D2 + 1];
+uint16_t (*Cube3x3OptimalSolver::m_cornerOrientationMoveTable)[MOVE_D2 + 1];
+uint16_t (*Cube3x3OptimalSolver::m_edgeGroupMoveTable)[MOVE_D2 + 1];
+uint32_t (*Cube3x3OptimalSolver::m_edgeGroupMergeTable)[EDGE_GROUP_POSITION_INDEX_COUNT];
+uint8_t* Cube3x3OptimalSolver::m_cornerPruneTable;
+uint8_t* Cube3x3OptimalSolver::m_edgePruneTables[2];
+
+
+// Cube state used for computing symmetries. Unlike Cube3x3, this can represent mirrored cubes,
+// which use corner orientations 3 to 5.
+struct SymmetryCube
+{
+	CubePiece corners[8];
+	CubePiece edges[12];
+};
+
+// Rotation by 180 degrees around the F/B axis
+static const SymmetryCube g_rotateF2Symmetry = {
+	{
+		{CORNER_DLF, 0}, {CORNER_DFR, 0}, {CORNER_DRB, 0}, {CORNER_DBL, 0},
+		{CORNER_UFL, 0}, {CORNER_URF, 0}, {CORNER_UBR, 0}, {CORNER_ULB, 0}
+	},
+	{
+		{EDGE_DL, 0}, {EDGE_DF, 0}, {EDGE_DR, 0}, {EDGE_DB, 0}, {EDGE_UL, 0}, {EDGE_UF, 0},
+		{EDGE_UR, 0}, {EDGE_UB, 0}, {EDGE_FL, 0}, {EDGE_FR, 0}, {EDGE_BR, 0}, {EDGE_BL, 0}
+	}
+};
+
+// Rotation by 90 degrees around the U/D axis
+static const SymmetryCube g_rotateU4Symmetry = {
+	{
+		{CORNER_UBR, 0}, {CORNER_URF, 0}, {CORNER_UFL, 0}, {CORNER_ULB, 0},
+		{CORNER_DRB, 0}, {CORNER_DFR, 0}, {CORNER_DLF, 0}, {CORNER_DBL, 0}
+	},
+	{
+		{EDGE_UB, 0}, {EDGE_UR, 0}, {EDGE_UF, 0}, {EDGE_UL, 0}, {EDGE_DB, 0}, {EDGE_DR, 0},
+		{EDGE_DF, 0}, {EDGE_DL, 0}, {EDGE_BR, 1}, {EDGE_FR, 1}, {EDGE_FL, 1}, {EDGE_BL, 1}
+	}
+};
+
+// Reflection through the plane between the L and R faces
+static const SymmetryCube g_mirrorLRSymmetry = {
+	{
+		{CORNER_UFL, 3}, {CORNER_URF, 3}, {CORNER_UBR, 3}, {CORNER_ULB, 3},
+		{CORNER_DLF, 3}, {CORNER_DFR, 3}, {CORNER_DRB, 3}, {CORNER_DBL, 3}
+	},
+	{
+		{EDGE_UL, 0}, {EDGE_UF, 0}, {EDGE_UR, 0}, {EDGE_UB, 0}, {EDGE_DL, 0}, {EDGE_DF, 0},
+		{EDGE_DR, 0}, {EDGE_DB, 0}, {EDGE_FL, 0}, {EDGE_FR, 0}, {EDGE_BR, 0}, {EDGE_BL, 0}
+	}
+};
+
+
+// Generates the solver tables into the table pointers of Cube3x3. The pointers must already
+// point at a writable block of memory of the size returned by Cube3x3::SetTableData. All of the
+// searches work directly on coordinate indicies using the move tables, and are spread across
+// all available cores.
+class Cube3x3TableGenerator
+{
+	SymmetryCube m_symmetries[UD_SYMMETRY_COUNT];
+	int m_symmetryInverse[UD_SYMMETRY_COUNT];
+	vector<uint32_t> m_flipSliceSymRepresentative;
+	vector<uint16_t> m_flipSliceSymStabilizer;
+	vector<uint16_t> m_cornerPermutationSymRepresentative;
+	vector<uint16_t> m_cornerPermutationSymStabilizer;
+
+	bool GenerateMoveTables();
+	bool GenerateSymmetryTables();
+	bool GeneratePhase2SymmetryTables();
+	void GeneratePhase1PruneTable();
+	void GeneratePhase2PruneTables();
+	void GenerateCornerPermutationAllMovesPruneTable();
+	void GenerateSortedEdgeAllMovesPruneTables();
+	bool GeneratePhase2EdgePermutationMergeTable();
+	bool GenerateEndgameTable();
+
+public:
+	bool Generate();
+};
+
+
+// Generates the pattern databases for the optimal solver into the table pointers of
+// Cube3x3OptimalSolver, in the same way as above.
+class Cube3x3OptimalTableGenerator
+{
+	vector<uint32_t> m_edgeGroupSplit;
+
+	bool GenerateMoveTables();
+	void GenerateEdgeGroupMergeTable();
+	void GenerateCornerPruneTable();
+	void GenerateEdgePruneTable(int half);
+
+public:
+	bool Generate();
+};
+
+
+static SymmetryCube MultiplySymmetryCube(const SymmetryCube& a, const SymmetryCube& b)
+{
+	SymmetryCube result;
+	for (size_t i = 0; i < 8; i++)
+	{
+		const CubePiece& src = a.corners[b.corners[i].piece];
+		int orientation;
+		if ((src.orientation < 3) && (b.corners[i].orientation < 3))
+		{
+			// Both are regular cubes
+			orientation = (src.orientation + b.corners[i].orientation) % 3;
+		}
+		else if (src.orientation < 3)
+		{
+			// Second cube is mirrored, result is mirrored
+			orientation = src.orientation + b.corners[i].orientation;
+			if (orientation >= 6)
+				orientation -= 3;
+		}
+		else if (b.corners[i].orientation < 3)
+		{
+			// First cube is mirrored, result is mirrored
+			orientation = src.orientation - b.corners[i].orientation;
+			if (orientation < 3)
+				orientation += 3;
+		}
+		else
+		{
+			// Both cubes are mirrored, result is a regular cube
+			orientation = src.orientation - b.corners[i].orientation;
+			if (orientation < 0)
+				orientation += 3;
+		}
+		result.corners[i] = CubePiece { src.piece, (uint8_t)orientation };
+	}
+	for (size_t i = 0; i < 12; i++)
+	{
+		const CubePiece& src = a.edges[b.edges[i].piece];
+		result.edges[i] = CubePiece { src.piece, (uint8_t)(src.orientation ^ b.edges[i].orientation) };
+	}
+	return result;
+}
+
+
+static SymmetryCube IdentitySymmetryCube()
+{
+	SymmetryCube result;
+	for (uint8_t i = 0; i < 8; i++)
+		result.corners[i] = CubePiece { i, 0 };
+	for (uint8_t i = 0; i < 12; i++)
+		result.edges[i] = CubePiece { i, 0 };
+	return result;
+}
+
+
+static bool IsIdentitySymmetryCube(const SymmetryCube& cube)
+{
+	for (uint8_t i = 0; i < 8; i++)
+	{
+		if ((cube.corners[i].piece != i) || (cube.corners[i].orientation != 0))
+			return false;
+	}
+	for (uint8_t i = 0; i < 12; i++)
+	{
+		if ((cube.edges[i].piece != i) || (cube.edges[i].orientation != 0))
+			return false;
+	}
+	return true;
+}
+
+
+static Cube3x3 SymmetryCubeToCube(const SymmetryCube& cube)
+{
+	Cube3x3 result;
+	for (size_t i = 0; i < 8; i++)
+		result.Corner((CubeCorner)i) = cube.corners[i];
+	for (size_t i = 0; i < 12; i++)
+		result.Edge((CubeEdge)i) = cube.edges[i];
+	return result;
+}
+
+
+static bool IsPhase2Move(uint8_t move)
+{
+	// Phase 2 contains the moves (U, D, F2, R2, B2, L2)
+	return (move != MOVE_F) && (move != MOVE_Fp) &&
+		(move != MOVE_R) && (move != MOVE_Rp) &&
+		(move != MOVE_B) && (move != MOVE_Bp) &&
+		(move != MOVE_L) && (move != MOVE_Lp);
+}
+
+
+// Calls func(begin, end) for chunks of the range [0, count) on all available cores. Chunks are a
+// multiple of 64 entries, so a bit set word or a packed table word is only touched by one thread.
+template <class Func>
+static void ParallelFor(size_t count, Func func)
+{
+	atomic<size_t> nextChunk(0);
+	auto worker = [&]() {
+		while (true)
+		{
+			size_t begin = nextChunk.fetch_add(TABLE_SEARCH_CHUNK_SIZE);
+			if (begin >= count)
+				break;
+			func(begin, min(begin + TABLE_SEARCH_CHUNK_SIZE, count));
+		}
+	};
+
+	size_t threadCount = thread::hardware_concurrency();
+	vector<thread> threads;
+	for (size_t i = 1; i < threadCount; i++)
+		threads.push_back(thread(worker));
+	worker();
+	for (auto& i : threads)
+		i.join();
+}
+
+
+// Distance table with a byte for each entry
+struct ByteDistanceTable
+{
+	uint8_t* data;
+
+	bool IsVisited(size_t i) const { return data[i] != UNKNOWN_DISTANCE; }
+	void SetDistance(size_t i, int distance) { data[i] = (uint8_t)distance; }
+};
+
+// Distance table with the distance modulo 3 packed into 2 bits per entry. A value of 3 marks
+// entries that have not been visited. The table must start out filled with ones.
+struct Mod3DistanceTable
+{
+	uint64_t* data;
+
+	bool IsVisited(size_t i) const { return ((data[i / 32] >> (2 * (i % 32))) & 3) != 3; }
+	void SetDistance(size_t i, int distance)
+	{
+		int shift = 2 * (i % 32);
+		data[i / 32] = (data[i / 32] & ~(3ULL << shift)) | ((uint64_t)(distance % 3) << shift);
+	}
+};
+
+
+// Distance table with 4 bits per entry and two entries per byte. A value of 15 marks entries that
+// have not been visited. The table must start out filled with ones.
+struct NibbleDistanceTable
+{
+	uint8_t* data;
+
+	bool IsVisited(size_t i) const { return ((data[i / 2] >> (4 * (i % 2))) & 0xf) != 0xf; }
+	void SetDistance(size_t i, int distance)
+	{
+		int shift = 4 * (i % 2);
+		data[i / 2] = (uint8_t)((data[i / 2] & ~(0xf << shift)) | (distance << shift));
+	}
+};
+
+
+// Breadth first search over a coordinate space to find the distance of every index from the solved
+// index, which is zero unless given. The neighbors function calls visit(index) for each index that is
+// one move away, and stops early if visit returns false. Each depth is searched forwards from the
+// frontier while it is small, then backwards from the unvisited indicies once the frontier is large
+// compared to the rest of the space. New indicies are collected in a bit set and written to the table
+// after each pass.
+template <class Table, class Neighbors>
+static void SearchCoordinateSpace(Table& table, size_t count, Neighbors neighbors, size_t solved = 0)
+{
+	size_t wordCount = (count + 63) / 64;
+	vector<uint64_t> frontier(wordCount, 0);
+	unique_ptr<atomic<uint64_t>[]> next(new atomic<uint64_t>[wordCount]);
+	for (size_t i = 0; i < wordCount; i++)
+		next[i].store(0, memory_order_relaxed);
+
+	table.SetDistance(solved, 0);
+	frontier[solved / 64] = 1ULL << (solved % 64);
+	size_t visited = 1;
+	size_t frontierCount = 1;
+	for (int depth = 0; frontierCount > 0; depth++)
+	{
+		bool backwards = (frontierCount * 4) > (count - visited);
+		ParallelFor(count, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++)
+			{
+				if (backwards)
+				{
+					// Look for any neighbor in the frontier
+					if (table.IsVisited(i))
+						continue;
+					bool found = false;
+					neighbors(i, [&](size_t neighbor) {
+						found = (frontier[neighbor / 64] & (1ULL << (neighbor % 64))) != 0;
+						return !found;
+					});
+					if (found)
+						next[i / 64].fetch_or(1ULL << (i % 64), memory_order_relaxed);
+				}
+				else
+				{
+					// Skip quickly over empty parts of the frontier
+					if (frontier[i / 64] == 0)
+					{
+						i |= 63;
+						continue;
+					}
+					if (!(frontier[i / 64] & (1ULL << (i % 64))))
+						continue;
+					neighbors(i, [&](size_t neighbor) {
+						if (!table.IsVisited(neighbor))
+							next[neighbor / 64].fetch_or(1ULL << (neighbor % 64), memory_order_relaxed);
+						return true;
+					});
+				}
+			}
+		});
+
+		// Record the newly found indicies and make them the next frontier
+		atomic<size_t> found(0);
+		ParallelFor(count, [&](size_t begin, size_t end) {
+			size_t chunkFound = 0;
+			for (size_t word = begin / 64; word < ((end + 63) / 64); word++)
+			{
+				uint64_t bits = next[word].exchange(0, memory_order_relaxed);
+				frontier[word] = bits;
+				for (size_t bit = 0; bits != 0; bit++, bits >>= 1)
+				{
+					if (bits & 1)
+					{
+						table.SetDistance((word * 64) + bit, depth + 1);
+						chunkFound++;
+					}
+				}
+			}
+			found += chunkFound;
+		});
+		frontierCount = found;
+		visited += frontierCount;
+	}
+}
+
+
+// Generates the move table for a coordinate by setting up a cube for each index and applying every
+// move to it. Each index must round trip through the set and get functions. Moves that are not
+// explored are left as UNKNOWN_INDEX.
+template <class SetIndexFunc, class IndexFunc>
+static bool GenerateMoveTable(uint16_t (*table)[MOVE_D2 + 1], int count, bool phase2,
+	SetIndexFunc setIndex, IndexFunc getIndex)
+{
+	atomic<bool> valid(true);
+	ParallelFor(count, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++)
+		{
+			Cube3x3 cube;
+			setIndex(cube, (int)i);
+			if (getIndex(cube) != (int)i)
+			{
+				valid = false;
+				return;
+			}
+
+			for (uint8_t move = MOVE_U; move <= MOVE_D2; move++)
+			{
+				table[i][move] = UNKNOWN_INDEX;
+				if (phase2 && !IsPhase2Move(move))
+					continue;
+
+				Cube3x3 movedCube = cube;
+				movedCube.Move((CubeMove)move);
+				int newIndex = getIndex(movedCube);
+				if ((newIndex < 0) || (newIndex >= count))
+				{
+					valid = false;
+					return;
+				}
+				table[i][move] = newIndex;
+			}
+		}
+	});
+	return valid;
+}
+
+
+bool Cube3x3TableGenerator::GenerateMoveTables()
+{
+	if (!GenerateMoveTable(Cube3x3::m_cornerOrientationMoveTable, CORNER_ORIENTATION_INDEX_COUNT, false,
+		[](Cube3x3& cube, int idx) { cube.SetCornerOrientationIndex(idx); },
+		[](Cube3x3& cube) { return cube.GetCornerOrientationIndex(); }))
+		return false;
+	if (!GenerateMoveTable(Cube3x3::m_cornerPermutationMoveTable, CORNER_PERMUTATION_INDEX_COUNT, false,
+		[](Cube3x3& cube, int idx) { cube.SetCornerPermutationIndex(idx); },
+		[](Cube3x3& cube) { return cube.GetCornerPermutationIndex(); }))
+		return false;
+	if (!GenerateMoveTable(Cube3x3::m_edgeOrientationMoveTable, EDGE_ORIENTATION_INDEX_COUNT, false,
+		[](Cube3x3& cube, int idx) { cube.SetEdgeOrientationIndex(idx); },
+		[](Cube3x3& cube) { return cube.GetEdgeOrientationIndex(); }))
+		return false;
+	if (!GenerateMoveTable(Cube3x3::m_equatorialEdgeSliceMoveTable, EDGE_SLICE_INDEX_COUNT, false,
+		[](Cube3x3& cube, int idx) { cube.SetEquatorialEdgeSliceIndex(idx); },
+		[](Cube3x3& cube) { return cube.GetEquatorialEdgeSliceIndex(); }))
+		return false;
+	if (!GenerateMoveTable(Cube3x3::m_phase2EdgePermutationMoveTable, PHASE_2_EDGE_PERMUTATION_INDEX_COUNT, true,
+		[](Cube3x3& cube, int idx) { cube.SetPhase2EdgePermutationIndex(idx); },
+		[](Cube3x3& cube) { return cube.GetPhase2EdgePermutationIndex(); }))
+		return false;
+	if (!GenerateMoveTable(Cube3x3::m_phase2EquatorialEdgePermutationMoveTable,
+		PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT, true,
+		[](Cube3x3& cube, int idx) { cube.SetPhase2EquatorialEdgePermutationIndex(idx); },
+		[](Cube3x3& cube) { return cube.GetPhase2EquatorialEdgePermutationIndex(); }))
+		return false;
+
+	// The sorted edge move table is the same for every group of four edges, so only the equatorial
+	// edges need to be explored
+	if (!GenerateMoveTable(Cube3x3::m_sortedEdgeMoveTable, SORTED_EDGE_INDEX_COUNT, false,
+		[](Cube3x3& cube, int idx) { cube.SetSortedEdgeIndex(EDGE_FR, idx); },
+		[](Cube3x3& cube) { return cube.GetSortedEdgeIndex(EDGE_FR); }))
+		return false;
+
+	// Sanity check that the other edge groups agree with the shared move table,
+	// following a fixed pseudorandom move sequence
+	Cube3x3 cube;
+	uint32_t seed = 1;
+	for (int i = 0; i < 1000; i++)
+	{
+		seed = (seed * 1103515245) + 12345;
+		CubeMove move = (CubeMove)((seed >> 16) % (MOVE_D2 + 1));
+		int top = cube.GetSortedEdgeIndex(EDGE_UR);
+		int bottom = cube.GetSortedEdgeIndex(EDGE_DR);
+		cube.Move(move);
+		if ((Cube3x3::m_sortedEdgeMoveTable[top][move] != cube.GetSortedEdgeIndex(EDGE_UR)) ||
+			(Cube3x3::m_sortedEdgeMoveTable[bottom][move] != cube.GetSortedEdgeIndex(EDGE_DR)))
+			return false;
+	}
+	return true;
+}
+
+
+bool Cube3x3TableGenerator::GenerateSymmetryTables()
+{
+	// Generate all symmetries that preserve the U/D axis from the basic symmetries
+	SymmetryCube cube = IdentitySymmetryCube();
+	int idx = 0;
+	for (int f2 = 0; f2 < 2; f2++)
+	{
+		for (int u4 = 0; u4 < 4; u4++)
+		{
+			for (int lr2 = 0; lr2 < 2; lr2++)
+			{
+				m_symmetries[idx++] = cube;
+				cube = MultiplySymmetryCube(cube, g_mirrorLRSymmetry);
+			}
+			cube = MultiplySymmetryCube(cube, g_rotateU4Symmetry);
+		}
+		cube = MultiplySymmetryCube(cube, g_rotateF2Symmetry);
+	}
+	for (int i = 0; i < UD_SYMMETRY_COUNT; i++)
+	{
+		for (int j = 0; j < UD_SYMMETRY_COUNT; j++)
+		{
+			if (IsIdentitySymmetryCube(MultiplySymmetryCube(m_symmetries[i], m_symmetries[j])))
+				m_symmetryInverse[i] = j;
+		}
+	}
+
+	// Find an edge arrangement for each equatorial edge slice index
+	CubePiece sliceEdges[EDGE_SLICE_INDEX_COUNT][12];
+	for (int mask = 0; mask < (1 << 12); mask++)
+	{
+		int count = 0;
+		for (int i = 0; i < 12; i++)
+		{
+			if (mask & (1 << i))
+				count++;
+		}
+		if (count != 4)
+			continue;
+
+		SymmetryCube cur = IdentitySymmetryCube();
+		uint8_t nextSliceEdge = EDGE_FR;
+		uint8_t nextOtherEdge = EDGE_UR;
+		for (int i = 0; i < 12; i++)
+			cur.edges[i].piece = (mask & (1 << i)) ? nextSliceEdge++ : nextOtherEdge++;
+		int slice = SymmetryCubeToCube(cur).GetEquatorialEdgeSliceIndex();
+		memcpy(sliceEdges[slice], cur.edges, sizeof(cur.edges));
+	}
+
+	// Group the combined edge orientation and equatorial edge slice indicies into classes of
+	// states that are equivalent under symmetry
+	uint32_t* flipSliceSymTable = &Cube3x3::m_flipSliceSymTable[0][0];
+	for (int i = 0; i < EDGE_ORIENTATION_INDEX_COUNT * EDGE_SLICE_INDEX_COUNT; i++)
+		flipSliceSymTable[i] = 0xffffffff;
+	m_flipSliceSymRepresentative.resize(FLIP_SLICE_SYM_INDEX_COUNT);
+	m_flipSliceSymStabilizer.resize(FLIP_SLICE_SYM_INDEX_COUNT);
+	int classCount = 0;
+	for (int flip = 0; flip < EDGE_ORIENTATION_INDEX_COUNT; flip++)
+	{
+		for (int slice = 0; slice < EDGE_SLICE_INDEX_COUNT; slice++)
+		{
+			int rawIdx = (flip * EDGE_SLICE_INDEX_COUNT) + slice;
+			if (flipSliceSymTable[rawIdx] != 0xffffffff)
+				continue;
+			if (classCount >= FLIP_SLICE_SYM_INDEX_COUNT)
+				return false;
+
+			SymmetryCube rep = IdentitySymmetryCube();
+			memcpy(rep.edges, sliceEdges[slice], sizeof(rep.edges));
+			int parity = 0;
+			for (int i = 0; i < 11; i++)
+			{
+				rep.edges[i].orientation = (flip >> (10 - i)) & 1;
+				parity ^= rep.edges[i].orientation;
+			}
+			rep.edges[11].orientation = parity;
+
+			m_flipSliceSymRepresentative[classCount] = rawIdx;
+			m_flipSliceSymStabilizer[classCount] = 0;
+			for (int sym = 0; sym < UD_SYMMETRY_COUNT; sym++)
+			{
+				// State is the inverse symmetry applied to the representative
+				Cube3x3 conjugate = SymmetryCubeToCube(MultiplySymmetryCube(
+					MultiplySymmetryCube(m_symmetries[m_symmetryInverse[sym]], rep), m_symmetries[sym]));
+				int conjugateIdx = (conjugate.GetEdgeOrientationIndex() * EDGE_SLICE_INDEX_COUNT) +
+					conjugate.GetEquatorialEdgeSliceIndex();
+				if (flipSliceSymTable[conjugateIdx] == 0xffffffff)
+					flipSliceSymTable[conjugateIdx] = (classCount << 4) | sym;
+				if (conjugateIdx == rawIdx)
+					m_flipSliceSymStabilizer[classCount] |= 1 << sym;
+			}
+			classCount++;
+		}
+	}
+	if (classCount != FLIP_SLICE_SYM_INDEX_COUNT)
+		return false;
+
+	// Generate the effect of each symmetry on the corner orientation
+	for (int twist = 0; twist < CORNER_ORIENTATION_INDEX_COUNT; twist++)
+	{
+		SymmetryCube cur = IdentitySymmetryCube();
+		int sum = 0;
+		for (int i = 6, value = twist; i >= 0; i--, value /= 3)
+		{
+			cur.corners[i].orientation = value % 3;
+			sum += value % 3;
+		}
+		cur.corners[7].orientation = (3 - (sum % 3)) % 3;
+
+		for (int sym = 0; sym < UD_SYMMETRY_COUNT; sym++)
+		{
+			Cube3x3 conjugate = SymmetryCubeToCube(MultiplySymmetryCube(
+				MultiplySymmetryCube(m_symmetries[sym], cur), m_symmetries[m_symmetryInverse[sym]]));
+			Cube3x3::m_cornerOrientationSymTable[twist][sym] = conjugate.GetCornerOrientationIndex();
+		}
+	}
+	return true;
+}
+
+
+bool Cube3x3TableGenerator::GeneratePhase2SymmetryTables()
+{
+	// Find a corner arrangement for each corner permutation index
+	vector<SymmetryCube> cornerPermutations(CORNER_PERMUTATION_INDEX_COUNT);
+	uint8_t corners[8] = {CORNER_URF, CORNER_UFL, CORNER_ULB, CORNER_UBR,
+		CORNER_DFR, CORNER_DLF, CORNER_DBL, CORNER_DRB};
+	do
+	{
+		SymmetryCube cur = IdentitySymmetryCube();
+		for (int i = 0; i < 8; i++)
+			cur.corners[i].piece = corners[i];
+		cornerPermutations[SymmetryCubeToCube(cur).GetCornerPermutationIndex()] = cur;
+	} while (next_permutation(&corners[0], &corners[8]));
+
+	// Group the corner permutations into classes of states that are equivalent under symmetry
+	uint16_t* cornerPermutationSymTable = Cube3x3::m_cornerPermutationSymTable;
+	for (int i = 0; i < CORNER_PERMUTATION_INDEX_COUNT; i++)
+		cornerPermutationSymTable[i] = 0xffff;
+	m_cornerPermutationSymRepresentative.resize(CORNER_PERMUTATION_SYM_INDEX_COUNT);
+	m_cornerPermutationSymStabilizer.resize(CORNER_PERMUTATION_SYM_INDEX_COUNT);
+	int classCount = 0;
+	for (int rawIdx = 0; rawIdx < CORNER_PERMUTATION_INDEX_COUNT; rawIdx++)
+	{
+		if (cornerPermutationSymTable[rawIdx] != 0xffff)
+			continue;
+		if (classCount >= CORNER_PERMUTATION_SYM_INDEX_COUNT)
+			return false;
+
+		m_cornerPermutationSymRepresentative[classCount] = rawIdx;
+		m_cornerPermutationSymStabilizer[classCount] = 0;
+		for (int sym = 0; sym < UD_SYMMETRY_COUNT; sym++)
+		{
+			// State is the inverse symmetry applied to the representative
+			Cube3x3 conjugate = SymmetryCubeToCube(MultiplySymmetryCube(
+				MultiplySymmetryCube(m_symmetries[m_symmetryInverse[sym]], cornerPermutations[rawIdx]),
+				m_symmetries[sym]));
+			int conjugateIdx = conjugate.GetCornerPermutationIndex();
+			if (cornerPermutationSymTable[conjugateIdx] == 0xffff)
+				cornerPermutationSymTable[conjugateIdx] = (classCount << 4) | sym;
+			if (conjugateIdx == rawIdx)
+				m_cornerPermutationSymStabilizer[classCount] |= 1 << sym;
+		}
+		classCount++;
+	}
+	if (classCount != CORNER_PERMUTATION_SYM_INDEX_COUNT)
+		return false;
+
+	// Generate the effect of each symmetry on the phase 2 edge permutation. The symmetries keep the
+	// equatorial edges within the equatorial slice, so the top and bottom edges stay in phase 2.
+	uint8_t edges[8] = {EDGE_UR, EDGE_UF, EDGE_UL, EDGE_UB, EDGE_DR, EDGE_DF, EDGE_DL, EDGE_DB};
+	do
+	{
+		SymmetryCube cur = IdentitySymmetryCube();
+		for (int i = 0; i < 8; i++)
+			cur.edges[i].piece = edges[i];
+		int edgePermutation = SymmetryCubeToCube(cur).GetPhase2EdgePermutationIndex();
+
+		for (int sym = 0; sym < UD_SYMMETRY_COUNT; sym++)
+		{
+			Cube3x3 conjugate = SymmetryCubeToCube(MultiplySymmetryCube(
+				MultiplySymmetryCube(m_symmetries[sym], cur), m_symmetries[m_symmetryInverse[sym]]));
+			Cube3x3::m_phase2EdgePermutationSymTable[edgePermutation][sym] =
+				conjugate.GetPhase2EdgePermutationIndex();
+		}
+	} while (next_permutation(&edges[0], &edges[8]));
+	return true;
+}
+
+
+void Cube3x3TableGenerator::GeneratePhase1PruneTable()
+{
+	memset(Cube3x3::m_phase1PruneTable, 0xff, sizeof(uint64_t) * ((PHASE_1_PRUNE_INDEX_COUNT + 31) / 32));
+	Mod3DistanceTable table = { Cube3x3::m_phase1PruneTable };
+
+	SearchCoordinateSpace(table, PHASE_1_PRUNE_INDEX_COUNT, [&](size_t i, auto&& visit) {
+		int flipSliceClass = (int)(i / CORNER_ORIENTATION_INDEX_COUNT);
+		int twist = (int)(i % CORNER_ORIENTATION_INDEX_COUNT);
+		int flip = m_flipSliceSymRepresentative[flipSliceClass] / EDGE_SLICE_INDEX_COUNT;
+		int slice = m_flipSliceSymRepresentative[flipSliceClass] % EDGE_SLICE_INDEX_COUNT;
+		for (uint8_t move = MOVE_U; move <= MOVE_D2; move++)
+		{
+			int newFlip = Cube3x3::m_edgeOrientationMoveTable[flip][move];
+			int newSlice = Cube3x3::m_equatorialEdgeSliceMoveTable[slice][move];
+			int newTwist = Cube3x3::m_cornerOrientationMoveTable[twist][move];
+			uint32_t newFlipSlice = Cube3x3::m_flipSliceSymTable[newFlip][newSlice];
+			int newFlipSliceClass = newFlipSlice >> 4;
+			newTwist = Cube3x3::m_cornerOrientationSymTable[newTwist][newFlipSlice & 0xf];
+			size_t base = (size_t)newFlipSliceClass * CORNER_ORIENTATION_INDEX_COUNT;
+			if (!visit(base + newTwist))
+				return;
+
+			// If the class representative is unchanged by some symmetries, the states reached by applying
+			// those symmetries to the corner orientation are equivalent
+			uint16_t stabilizer = m_flipSliceSymStabilizer[newFlipSliceClass];
+			for (int sym = 1; stabilizer > 1 && sym < UD_SYMMETRY_COUNT; sym++)
+			{
+				if ((stabilizer & (1 << sym)) && !visit(base + Cube3x3::m_cornerOrientationSymTable[newTwist][sym]))
+					return;
+			}
+		}
+	});
+}
+
+
+void Cube3x3TableGenerator::GeneratePhase2PruneTables()
+{
+	ByteDistanceTable cornerTable = { &Cube3x3::m_cornerPermutationPruneTable[0][0] };
+	memset(cornerTable.data, UNKNOWN_DISTANCE,
+		CORNER_PERMUTATION_INDEX_COUNT * PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT);
+	SearchCoordinateSpace(cornerTable, CORNER_PERMUTATION_INDEX_COUNT * PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT,
+		[&](size_t i, auto&& visit) {
+			int cornerPermutation = (int)(i / PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT);
+			int equatorialEdgePermutation = (int)(i % PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT);
+			for (uint8_t move = MOVE_U; move <= MOVE_D2; move++)
+			{
+				if (!IsPhase2Move(move))
+					continue;
+				if (!visit(((size_t)Cube3x3::m_cornerPermutationMoveTable[cornerPermutation][move] *
+					PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT) +
+					Cube3x3::m_phase2EquatorialEdgePermutationMoveTable[equatorialEdgePermutation][move]))
+					return;
+			}
+		});
+
+	ByteDistanceTable edgeTable = { &Cube3x3::m_phase2EdgePermutationPruneTable[0][0] };
+	memset(edgeTable.data, UNKNOWN_DISTANCE,
+		PHASE_2_EDGE_PERMUTATION_INDEX_COUNT * PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT);
+	SearchCoordinateSpace(edgeTable, PHASE_2_EDGE_PERMUTATION_INDEX_COUNT * PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT,
+		[&](size_t i, auto&& visit) {
+			int edgePermutation = (int)(i / PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT);
+			int equatorialEdgePermutation = (int)(i % PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT);
+			for (uint8_t move = MOVE_U; move <= MOVE_D2; move++)
+			{
+				if (!IsPhase2Move(move))
+					continue;
+				if (!visit(((size_t)Cube3x3::m_phase2EdgePermutationMoveTable[edgePermutation][move] *
+					PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT) +
+					Cube3x3::m_phase2EquatorialEdgePermutationMoveTable[equatorialEdgePermutation][move]))
+					return;
+			}
+		});
+
+	// Phase 2 must solve the corner permutation with any equatorial edge permutation, so the
+	// minimum over all of them is a lower bound during phase 1
+	for (int i = 0; i < CORNER_PERMUTATION_INDEX_COUNT; i++)
+	{
+		uint8_t minValue = Cube3x3::m_cornerPermutationPruneTable[i][0];
+		for (int j = 0; j < PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT; j++)
+			minValue = min(minValue, Cube3x3::m_cornerPermutationPruneTable[i][j]);
+		Cube3x3::m_phase1CornerPermutationPruneTable[i] = minValue;
+	}
+
+	// Combined corner and edge permutation table, reduced by symmetry in the same way as the
+	// phase 1 table
+	memset(Cube3x3::m_phase2PruneTable, 0xff, sizeof(uint64_t) * ((PHASE_2_PRUNE_INDEX_COUNT + 31) / 32));
+	Mod3DistanceTable table = { Cube3x3::m_phase2PruneTable };
+	SearchCoordinateSpace(table, PHASE_2_PRUNE_INDEX_COUNT, [&](size_t i, auto&& visit) {
+		int cornerPermutationClass = (int)(i / PHASE_2_EDGE_PERMUTATION_INDEX_COUNT);
+		int edgePermutation = (int)(i % PHASE_2_EDGE_PERMUTATION_INDEX_COUNT);
+		int cornerPermutation = m_cornerPermutationSymRepresentative[cornerPermutationClass];
+		for (uint8_t move = MOVE_U; move <= MOVE_D2; move++)
+		{
+			if (!IsPhase2Move(move))
+				continue;
+			uint16_t newCornerPermutation = Cube3x3::m_cornerPermutationSymTable[
+				Cube3x3::m_cornerPermutationMoveTable[cornerPermutation][move]];
+			int newCornerPermutationClass = newCornerPermutation >> 4;
+			int newEdgePermutation = Cube3x3::m_phase2EdgePermutationSymTable[
+				Cube3x3::m_phase2EdgePermutationMoveTable[edgePermutation][move]][newCornerPermutation & 0xf];
+			size_t base = (size_t)newCornerPermutationClass * PHASE_2_EDGE_PERMUTATION_INDEX_COUNT;
+			if (!visit(base + newEdgePermutation))
+				return;
+
+			uint16_t stabilizer = m_cornerPermutationSymStabilizer[newCornerPermutationClass];
+			for (int sym = 1; stabilizer > 1 && sym < UD_SYMMETRY_COUNT; sym++)
+			{
+				if ((stabilizer & (1 << sym)) &&
+					!visit(base + Cube3x3::m_phase2EdgePermutationSymTable[newEdgePermutation][sym]))
+					return;
+			}
+		}
+	});
+}
+
+
+void Cube3x3TableGenerator::GenerateCornerPermutationAllMovesPruneTable()
+{
+	ByteDistanceTable table = { Cube3x3::m_cornerPermutationAllMovesPruneTable };
+	memset(table.data, UNKNOWN_DISTANCE, CORNER_PERMUTATION_INDEX_COUNT);
+	SearchCoordinateSpace(table, CORNER_PERMUTATION_INDEX_COUNT, [&](size_t i, auto&& visit) {
+		for (uint8_t move = MOVE_U; move <= MOVE_D2; move++)
+		{
+			if (!visit(Cube3x3::m_cornerPermutationMoveTable[i][move]))
+				return;
+		}
+	});
+}
+
+
+void Cube3x3TableGenerator::GenerateSortedEdgeAllMovesPruneTables()
+{
+	// The groups share a move table but have a different index when solved
+	Cube3x3 solved;
+	CubeEdge firstEdges[3] = {EDGE_UR, EDGE_DR, EDGE_FR};
+	for (int group = 0; group < 3; group++)
+	{
+		ByteDistanceTable table = { Cube3x3::m_sortedEdgeAllMovesPruneTable[group] };
+		memset(table.data, UNKNOWN_DISTANCE, SORTED_EDGE_INDEX_COUNT);
+		SearchCoordinateSpace(table, SORTED_EDGE_INDEX_COUNT, [&](size_t i, auto&& visit) {
+			for (uint8_t move = MOVE_U; move <= MOVE_D2; move++)
+			{
+				if (!visit(Cube3x3::m_sortedEdgeMoveTable[i][move]))
+					return;
+			}
+		}, solved.GetSortedEdgeIndex(firstEdges[group]));
+	}
+}
+
+
+bool Cube3x3TableGenerator::GeneratePhase2EdgePermutationMergeTable()
+{
+	// Entries that can't be reached in phase 2 are never used
+	memset(Cube3x3::m_phase2EdgePermutationMergeTable, 0,
+		sizeof(uint16_t) * PHASE_2_SORTED_EDGE_INDEX_COUNT * PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT);
+
+	// Go through every arrangement of the top and bottom edges with the equatorial edges solved
+	uint8_t edges[8] = {EDGE_UR, EDGE_UF, EDGE_UL, EDGE_UB, EDGE_DR, EDGE_DF, EDGE_DL, EDGE_DB};
+	do
+	{
+		Cube3x3 cube;
+		for (int i = 0; i < 8; i++)
+			cube.Edge((CubeEdge)i).piece = edges[i];
+
+		int top = cube.GetSortedEdgeIndex(EDGE_UR);
+		int bottom = cube.GetSortedEdgeIndex(EDGE_DR);
+		if ((top >= PHASE_2_SORTED_EDGE_INDEX_COUNT) || (bottom >= PHASE_2_SORTED_EDGE_INDEX_COUNT))
+			return false;
+		Cube3x3::m_phase2EdgePermutationMergeTable[top][bottom % PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT] =
+			cube.GetPhase2EdgePermutationIndex();
+	} while (next_permutation(&edges[0], &edges[8]));
+	return true;
+}
+
+bool Cube3x3TableGenerator::GenerateEndgameTable()
+{
+	memset(Cube3x3::m_endgameKeys, 0, sizeof(uint64_t) * ENDGAME_TABLE_SIZE);
+	memset(Cube3x3::m_endgameTable, 0xff, ENDGAME_TABLE_SIZE);
+
+	size_t count = 0;
+	auto insert = [&](uint64_t key, uint8_t value) {
+		size_t idx = (size_t)((key * 0x9e3779b97f4a7c15ULL) >> (64 - ENDGAME_TABLE_BITS));
+		while (Cube3x3::m_endgameTable[idx] != 0xff)
+			idx = (idx + 1) & (ENDGAME_TABLE_SIZE - 1);
+		Cube3x3::m_endgameKeys[idx] = key;
+		Cube3x3::m_endgameTable[idx] = value;
+		count++;
+	};
+
+	// Search outwards from the solved state, storing the inverse of the last move as the move
+	// that takes each new state towards solved
+	Cube3x3 solved;
+	Cube3x3::Phase1IndexCube solvedCube;
+	solvedCube.cornerOrientation = 0;
+	solvedCube.cornerPermutation = 0;
+	solvedCube.edgeOrientation = 0;
+	solvedCube.equatorialEdgeSlice = 0;
+	solvedCube.distance = 0;
+	solvedCube.sortedEquatorialEdges = solved.GetSortedEdgeIndex(EDGE_FR);
+	solvedCube.sortedTopEdges = solved.GetSortedEdgeIndex(EDGE_UR);
+	solvedCube.sortedBottomEdges = solved.GetSortedEdgeIndex(EDGE_DR);
+	vector<Cube3x3::Phase1IndexCube> frontier = { solvedCube };
+	insert(Cube3x3::GetEndgameKey(solvedCube), 0);
+	for (int depth = 1; depth <= MAX_3X3_ENDGAME_TABLE_MOVES; depth++)
+	{
+		vector<Cube3x3::Phase1IndexCube> next;
+		for (auto& i : frontier)
+		{
+			for (uint8_t move = MOVE_U; move <= MOVE_D2; move++)
+			{
+				Cube3x3::Phase1IndexCube cube = Cube3x3::MoveIndexCube(i, (CubeMove)move);
+				uint64_t key = Cube3x3::GetEndgameKey(cube);
+				if (Cube3x3::FindEndgameEntry(key) >= 0)
+					continue;
+
+				// Keep the table sparse enough for short probe sequences
+				if (count >= ((ENDGAME_TABLE_SIZE * 3) / 4))
+					return false;
+				insert(key, (uint8_t)((depth << 5) | CubeMoveSequence::InvertedMove((CubeMove)move)));
+				next.push_back(cube);
+			}
+		}
+		frontier.swap(next);
+	}
+	return true;
+}
+
+
+bool Cube3x3TableGenerator::Generate()
+{
+	if (!GenerateMoveTables())
+		return false;
+	if (!GenerateSymmetryTables())
+		return false;
+	if (!GeneratePhase2SymmetryTables())
+		return false;
+	GeneratePhase1PruneTable();
+	GeneratePhase2PruneTables();
+	GenerateCornerPermutationAllMovesPruneTable();
+	GenerateSortedEdgeAllMovesPruneTables();
+	if (!GeneratePhase2EdgePermutationMergeTable())
+		return false;
+	return GenerateEndgameTable();
+}
+
+
+bool Cube3x3OptimalTableGenerator::GenerateMoveTables()
+{
+	if (!GenerateMoveTable(Cube3x3OptimalSolver::m_cornerPermutationMoveTable, CORNER_PERMUTATION_INDEX_COUNT, false,
+		[](Cube3x3& cube, int idx) { cube.SetCornerPermutationIndex(idx); },
+		[](Cube3x3& cube) { return cube.GetCornerPermutationIndex(); }))
+		return false;
+	if (!GenerateMoveTable(Cube3x3OptimalSolver::m_cornerOrientationMoveTable, CORNER_ORIENTATION_INDEX_COUNT, false,
+		[](Cube3x3& cube, int idx) { cube.SetCornerOrientationIndex(idx); },
+		[](Cube3x3& cube) { return cube.GetCornerOrientationIndex(); }))
+		return false;
+
+	// Edges move the same way regardless of which edge it is, so the table for the first group
+	// works for all groups
+	return GenerateMoveTable(Cube3x3OptimalSolver::m_edgeGroupMoveTable, EDGE_GROUP_INDEX_COUNT, false,
+		[](Cube3x3& cube, int idx) { Cube3x3OptimalSolver::SetEdgeGroupIndex(cube, EDGE_UR, idx); },
+		[](Cube3x3& cube) { return Cube3x3OptimalSolver::GetEdgeGroupIndex(cube, EDGE_UR); });
+}
+
+
+// Gets the three edge positions from the position part of an edge group index
+static void GetEdgeGroupPositions(int idx, int positions[3])
+{
+	int choices[3] = {idx / 110, (idx / 10) % 11, idx % 10};
+	bool used[12] = {};
+	for (int i = 0; i < 3; i++)
+	{
+		int pos = 0;
+		for (int choice = choices[i]; used[pos] || (choice > 0); pos++)
+		{
+			if (!used[pos])
+				choice--;
+		}
+		positions[i] = pos;
+		used[pos] = true;
+	}
+}
+
+
+void Cube3x3OptimalTableGenerator::GenerateEdgeGroupMergeTable()
+{
+	// The six edge position index is the index of the choice in the remaining possible positions
+	// for each edge, so the positions of the first two groups being solved is index zero
+	m_edgeGroupSplit.resize(EDGE_HALF_POSITION_INDEX_COUNT);
+	for (int first = 0; first < EDGE_GROUP_POSITION_INDEX_COUNT; first++)
+	{
+		for (int second = 0; second < EDGE_GROUP_POSITION_INDEX_COUNT; second++)
+		{
+			int positions[6];
+			GetEdgeGroupPositions(first, &positions[0]);
+			GetEdgeGroupPositions(second, &positions[3]);
+
+			uint32_t idx = 0;
+			bool valid = true;
+			for (int i = 0; i < 6; i++)
+			{
+				int choice = positions[i];
+				for (int j = 0; j < i; j++)
+				{
+					if (positions[j] == positions[i])
+						valid = false;
+					else if (positions[j] < positions[i])
+						choice--;
+				}
+				idx = (idx * (12 - i)) + choice;
+			}
+
+			if (valid)
+			{
+				Cube3x3OptimalSolver::m_edgeGroupMergeTable[first][second] = idx;
+				m_edgeGroupSplit[idx] = (first << 16) | second;
+			}
+			else
+			{
+				Cube3x3OptimalSolver::m_edgeGroupMergeTable[first][second] = 0xffffffff;
+			}
+		}
+	}
+}
+
+
+void Cube3x3OptimalTableGenerator::GenerateCornerPruneTable()
+{
+	memset(Cube3x3OptimalSolver::m_cornerPruneTable, 0xff, CORNER_PRUNE_INDEX_COUNT / 2);
+	NibbleDistanceTable table = { Cube3x3OptimalSolver::m_cornerPruneTable };
+	SearchCoordinateSpace(table, CORNER_PRUNE_INDEX_COUNT, [&](size_t i, auto&& visit) {
+		int cornerPermutation = (int)(i / CORNER_ORIENTATION_INDEX_COUNT);
+		int cornerOrientation = (int)(i % CORNER_ORIENTATION_INDEX_COUNT);
+		for (uint8_t move = MOVE_U; move <= MOVE_D2; move++)
+		{
+			if (!visit(((size_t)Cube3x3OptimalSolver::m_cornerPermutationMoveTable[cornerPermutation][move] *
+				CORNER_ORIENTATION_INDEX_COUNT) +
+				Cube3x3OptimalSolver::m_cornerOrientationMoveTable[cornerOrientation][move]))
+				return;
+		}
+	});
+}
+
+
+void Cube3x3OptimalTableGenerator::GenerateEdgePruneTable(int half)
+{
+	uint8_t* data = Cube3x3OptimalSolver::m_edgePruneTables[half];
+	memset(data, 0xff, EDGE_HALF_PRUNE_INDEX_COUNT / 2);
+	NibbleDistanceTable table = { data };
+
+	// The last six edges are not at index zero when solved
+	Cube3x3 solved;
+	size_t solvedIdx = Cube3x3OptimalSolver::GetEdgePruneIndex(
+		Cube3x3OptimalSolver::GetEdgeGroupIndex(solved, half * 6),
+		Cube3x3OptimalSolver::GetEdgeGroupIndex(solved, (half * 6) + 3));
+
+	SearchCoordinateSpace(table, EDGE_HALF_PRUNE_INDEX_COUNT, [&](size_t i, auto&& visit) {
+		uint32_t split = m_edgeGroupSplit[i / 64];
+		int first = ((split >> 16) * 8) + ((i / 8) % 8);
+		int second = ((split & 0xffff) * 8) + (i % 8);
+		for (uint8_t move = MOVE_U; move <= MOVE_D2; move++)
+		{
+			if (!visit(Cube3x3OptimalSolver::GetEdgePruneIndex(
+				Cube3x3OptimalSolver::m_edgeGroupMoveTable[first][move],
+				Cube3x3OptimalSolver::m_edgeGroupMoveTable[second][move])))
+				return;
+		}
+	}, solvedIdx);
+}
+
+
+bool Cube3x3OptimalTableGenerator::Generate()
+{
+	if (!GenerateMoveTables())
+		return false;
+	GenerateEdgeGroupMergeTable();
+	GenerateCornerPruneTable();
+	GenerateEdgePruneTable(0);
+	GenerateEdgePruneTable(1);
+	return true;
+}
+
+
+// Points a table at the next aligned location in the table data. If data is null, only the
+// size is computed, so that the current tables are left untouched.
+template <class T>
+static void SetTable(T*& table, size_t count, uint8_t* data, size_t& offset)
+{
+	if (data)
+		table = (T*)(data + offset);
+	offset += ((sizeof(T) * count) + TABLE_ALIGNMENT - 1) & ~(size_t)(TABLE_ALIGNMENT - 1);
+}
+
+
+size_t Cube3x3::SetTableData(uint8_t* data)
+{
+	size_t offset = 0;
+	SetTable(m_cornerOrientationMoveTable, CORNER_ORIENTATION_INDEX_COUNT, data, offset);
+	SetTable(m_cornerPermutationMoveTable, CORNER_PERMUTATION_INDEX_COUNT, data, offset);
+	SetTable(m_edgeOrientationMoveTable, EDGE_ORIENTATION_INDEX_COUNT, data, offset);
+	SetTable(m_equatorialEdgeSliceMoveTable, EDGE_SLICE_INDEX_COUNT, data, offset);
+	SetTable(m_phase2EdgePermutationMoveTable, PHASE_2_EDGE_PERMUTATION_INDEX_COUNT, data, offset);
+	SetTable(m_phase2EquatorialEdgePermutationMoveTable, PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT, data, offset);
+	SetTable(m_sortedEdgeMoveTable, SORTED_EDGE_INDEX_COUNT, data, offset);
+	SetTable(m_phase2EdgePermutationMergeTable, PHASE_2_SORTED_EDGE_INDEX_COUNT, data, offset);
+	SetTable(m_flipSliceSymTable, EDGE_ORIENTATION_INDEX_COUNT, data, offset);
+	SetTable(m_cornerOrientationSymTable, CORNER_ORIENTATION_INDEX_COUNT, data, offset);
+	SetTable(m_cornerPermutationSymTable, CORNER_PERMUTATION_INDEX_COUNT, data, offset);
+	SetTable(m_phase2EdgePermutationSymTable, PHASE_2_EDGE_PERMUTATION_INDEX_COUNT, data, offset);
+	SetTable(m_phase1PruneTable, (PHASE_1_PRUNE_INDEX_COUNT + 31) / 32, data, offset);
+	SetTable(m_phase2PruneTable, (PHASE_2_PRUNE_INDEX_COUNT + 31) / 32, data, offset);
+	SetTable(m_cornerPermutationPruneTable, CORNER_PERMUTATION_INDEX_COUNT, data, offset);
+	SetTable(m_phase2EdgePermutationPruneTable, PHASE_2_EDGE_PERMUTATION_INDEX_COUNT, data, offset);
+	SetTable(m_phase1CornerPermutationPruneTable, CORNER_PERMUTATION_INDEX_COUNT, data, offset);
+	SetTable(m_cornerPermutationAllMovesPruneTable, CORNER_PERMUTATION_INDEX_COUNT, data, offset);
+	SetTable(m_sortedEdgeAllMovesPruneTable, 3, data, offset);
+	SetTable(m_endgameKeys, ENDGAME_TABLE_SIZE, data, offset);
+	SetTable(m_endgameTable, ENDGAME_TABLE_SIZE, data, offset);
+	return offset;
+}
+
+
+size_t Cube3x3OptimalSolver::SetTableData(uint8_t* data)
+{
+	size_t offset = 0;
+	SetTable(m_cornerPermutationMoveTable, CORNER_PERMUTATION_INDEX_COUNT, data, offset);
+	SetTable(m_cornerOrientationMoveTable, CORNER_ORIENTATION_INDEX_COUNT, data, offset);
+	SetTable(m_edgeGroupMoveTable, EDGE_GROUP_INDEX_COUNT, data, offset);
+	SetTable(m_edgeGroupMergeTable, EDGE_GROUP_POSITION_INDEX_COUNT, data, offset);
+	SetTable(m_cornerPruneTable, CORNER_PRUNE_INDEX_COUNT / 2, data, offset);
+	SetTable(m_edgePruneTables[0], EDGE_HALF_PRUNE_INDEX_COUNT / 2, data, offset);
+	SetTable(m_edgePruneTables[1], EDGE_HALF_PRUNE_INDEX_COUNT / 2, data, offset);
+	return offset;
+}
+
+
+static uint64_t GetTableChecksum(const uint8_t* data, size_t size)
+{
+	// FNV-1a over 64-bit words. Table data is always a multiple of the table alignment in size.
+	const uint64_t* words = (const uint64_t*)data;
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for (size_t i = 0; i < (size / sizeof(uint64_t)); i++)
+		hash = (hash ^ words[i]) * 0x100000001b3ULL;
+	return hash;
+}
+
+
+static void UnmapTableFile(uint8_t* data, size_t size)
+{
+#ifdef _WIN32
+	(void)size;
+	UnmapViewOfFile(data);
+#else
+	munmap(data, size);
+#endif
+}
+
+
+// Maps the table file into memory and returns a pointer to the table data, or null if the file
+// is missing or does not contain valid tables of the expected format and size. Verifying the
+// checksum reads the entire file, so it is only done for a newly written file.
+static uint8_t* MapTableFile(const string& path, const char* magic, uint32_t version, size_t dataSize,
+	bool verifyChecksum)
+{
+	size_t fileSize = sizeof(TableFileHeader) + dataSize;
+	uint8_t* data;
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return nullptr;
+	LARGE_INTEGER actualSize;
+	if ((!GetFileSizeEx(file, &actualSize)) || ((uint64_t)actualSize.QuadPart != fileSize))
+	{
+		CloseHandle(file);
+		return nullptr;
+	}
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if (!mapping)
+		return nullptr;
+	data = (uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (!data)
+		return nullptr;
+#else
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return nullptr;
+	struct stat st;
+	if ((fstat(fd, &st) != 0) || ((uint64_t)st.st_size != fileSize))
+	{
+		close(fd);
+		return nullptr;
+	}
+	void* view = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (view == MAP_FAILED)
+		return nullptr;
+	data = (uint8_t*)view;
+#endif
+
+	const TableFileHeader* header = (const TableFileHeader*)data;
+	if ((memcmp(header->magic, magic, sizeof(header->magic)) != 0) ||
+		(header->version != version) || (header->byteOrder != TABLE_FILE_BYTE_ORDER) ||
+		(header->dataSize != dataSize) || (verifyChecksum &&
+		(header->checksum != GetTableChecksum(data + sizeof(TableFileHeader), dataSize))))
+	{
+		UnmapTableFile(data, fileSize);
+		return nullptr;
+	}
+	return data + sizeof(TableFileHeader);
+}
+
+
+static bool WriteTableFile(const string& path, const char* magic, uint32_t version, const uint8_t* data,
+	size_t dataSize)
+{
+	TableFileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, magic, sizeof(header.magic));
+	header.version = version;
+	header.byteOrder = TABLE_FILE_BYTE_ORDER;
+	header.dataSize = dataSize;
+	header.checksum = GetTableChecksum(data, dataSize);
+
+	// Write to a temporary file first so that a partially written file is never loaded
+	string tempPath = path + ".tmp";
+	FILE* fp = fopen(tempPath.c_str(), "wb");
+	if (!fp)
+		return false;
+	bool ok = (fwrite(&header, sizeof(header), 1, fp) == 1) && (fwrite(data, 1, dataSize, fp) == dataSize);
+	if (fclose(fp) != 0)
+		ok = false;
+
+#ifdef _WIN32
+	if (ok && !MoveFileExA(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING))
+		ok = false;
+#else
+	if (ok && (rename(tempPath.c_str(), path.c_str()) != 0))
+		ok = false;
+#endif
+
+	if (!ok)
+		remove(tempPath.c_str());
+	return ok;
+}
+
+
+// Maps the table file if there is a valid one, otherwise generates the tables and writes the table
+// file for next time. The setData function points the tables at a block of table data and returns
+// its size, and generate fills in the tables once they point at writable memory.
+template <class SetData, class Generate>
+static bool LoadTableFile(const string& path, const char* magic, uint32_t version, SetData setData, Generate generate)
+{
+	// Pages of a mapped file are loaded by the OS as they are used and are shared with any other
+	// processes using the same file.
+	size_t dataSize = setData(nullptr);
+	if (path.size() != 0)
+	{
+		uint8_t* data = MapTableFile(path, magic, version, dataSize, false);
+		if (data)
+		{
+			setData(data);
+			return true;
+		}
+	}
+
+	// No valid table file, generate the tables
+	uint8_t* data = new (nothrow) uint8_t[dataSize];
+	if (!data)
+		return false;
+	setData(data);
+	if (!generate())
+	{
+		delete[] data;
+		return false;
+	}
+
+	// Save the tables for next time. If this works, use the mapped file so that the memory
+	// can be shared and paged out like a loaded table file.
+	if ((path.size() != 0) && WriteTableFile(path, magic, version, data, dataSize))
+	{
+		uint8_t* mapped = MapTableFile(path, magic, version, dataSize, true);
+		if (mapped)
+		{
+			setData(mapped);
+			delete[] data;
+		}
+	}
+	return true;
+}
+
+
+void Cube3x3::SetTableFilePath(const string& path)
+{
+	lock_guard<mutex> lock(g_tableMutex);
+	g_tableFilePath = path;
+}
+
+
+void Cube3x3::PrepareTablesInBackground()
+{
+	if (g_tablesReady.load(memory_order_acquire))
+		return;
+	thread([]() { LoadTables(); }).detach();
+}
+
+
+bool Cube3x3::LoadTables()
+{
+	if (g_tablesReady.load(memory_order_acquire))
+		return true;
+
+	lock_guard<mutex> lock(g_tableMutex);
+	if (g_tablesReady.load(memory_order_relaxed))
+		return true;
+	if (g_tablesFailed)
+		return false;
+
+	if (!LoadTableFile(g_tableFilePath, g_tableFileMagic, TABLE_FILE_VERSION, SetTableData, []() {
+		Cube3x3TableGenerator generator;
+		return generator.Generate();
+	}))
+	{
+		g_tablesFailed = true;
+		return false;
+	}
+
+	g_tablesReady.store(true, memory_order_release);
+	return true;
+}
+
+
+bool Cube3x3::GenerateTableFile(const string& path)
+{
+	if (!LoadTables())
+		return false;
+
+	// The first table is at the start of the table data
+	return WriteTableFile(path, g_tableFileMagic, TABLE_FILE_VERSION, (const uint8_t*)m_cornerOrientationMoveTable,
+		SetTableData(nullptr));
+}
+
+
+void Cube3x3OptimalSolver::SetTableFilePath(const string& path)
+{
+	lock_guard<mutex> lock(g_optimalTableMutex);
+	g_optimalTableFilePath = path;
+}
+
+
+bool Cube3x3OptimalSolver::LoadTables()
+{
+	if (g_optimalTablesReady.load(memory_order_acquire))
+		return true;
+
+	lock_guard<mutex> lock(g_optimalTableMutex);
+	if (g_optimalTablesReady.load(memory_order_relaxed))
+		return true;
+	if (g_optimalTablesFailed)
+		return false;
+
+	if (!LoadTableFile(g_optimalTableFilePath, g_optimalTableFileMagic, OPTIMAL_TABLE_FILE_VERSION, SetTableData, []() {
+		Cube3x3OptimalTableGenerator generator;
+		return generator.Generate();
+	}))
+	{
+		g_optimalTablesFailed = true;
+		return false;
+	}
+
+	g_optimalTablesReady.store(true, memory_order_release);
+	return true;
+}
+
+
+bool Cube3x3OptimalSolver::GenerateTableFile(const string& path)
+{
+	if (!LoadTables())
+		return false;
+
+	// The first table is at the start of the table data
+	return WriteTableFile(path, g_optimalTableFileMagic, OPTIMAL_TABLE_FILE_VERSION,
+		(const uint8_t*)m_cornerPermutationMoveTable, SetTableData(nullptr));
+}
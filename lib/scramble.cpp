@@ -1,5 +1,14 @@
 #include "scramble.h"
 
+using namespace std;
+
+
+void RandomSource::Fill(int range, int* out, size_t n)
+{
+	for (size_t i = 0; i < n; i++)
+		out[i] = Next(range);
+}
+
 
 SimpleSeededRandomSource::SimpleSeededRandomSource(): m_seed(42)
 {
@@ -13,6 +22,99 @@ SimpleSeededRandomSource::SimpleSeededRandomSource(uint32_t seed): m_seed(seed)
 
 int SimpleSeededRandomSource::Next(int range)
 {
-	m_seed = (m_seed * 1103515245) + 12345;
-	return m_seed % range;
+	// Scale the output into the range with a multiply instead of taking the remainder, which uses
+	// the better upper bits of the generator. Outputs that would make some results more likely
+	// than others are rejected, so that large ranges are not biased.
+	uint32_t limit = (uint32_t)(-(int64_t)range) % (uint32_t)range;
+	while (true)
+	{
+		m_seed = (m_seed * 1103515245) + 12345;
+		uint64_t product = (uint64_t)m_seed * (uint32_t)range;
+		if ((uint32_t)product >= limit)
+			return (int)(product >> 32);
+	}
+}
+
+
+XoshiroRandomSource::XoshiroRandomSource(uint64_t seed)
+{
+	// Expand the seed into the full state with splitmix64, which never gives an all zero state
+	for (int i = 0; i < 4; i++)
+	{
+		seed += 0x9e3779b97f4a7c15ULL;
+		uint64_t z = seed;
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		m_state[i] = z ^ (z >> 31);
+	}
+}
+
+
+static inline uint64_t RotateLeft(uint64_t x, int k)
+{
+	return (x << k) | (x >> (64 - k));
+}
+
+
+inline uint64_t XoshiroRandomSource::NextValue()
+{
+	uint64_t result = RotateLeft(m_state[1] * 5, 7) * 9;
+	uint64_t t = m_state[1] << 17;
+	m_state[2] ^= m_state[0];
+	m_state[3] ^= m_state[1];
+	m_state[1] ^= m_state[2];
+	m_state[0] ^= m_state[3];
+	m_state[2] ^= t;
+	m_state[3] = RotateLeft(m_state[3], 45);
+	return result;
+}
+
+
+inline int XoshiroRandomSource::NextInRange(uint32_t range)
+{
+	// Scale the upper 32 bits into the range with a multiply. The low half of the product is only
+	// below the range when the result could be biased, so the remainder is rarely needed.
+	uint64_t product = (NextValue() >> 32) * range;
+	if ((uint32_t)product < range)
+	{
+		uint32_t limit = (uint32_t)(-(int64_t)range) % range;
+		while ((uint32_t)product < limit)
+			product = (NextValue() >> 32) * range;
+	}
+	return (int)(product >> 32);
+}
+
+
+int XoshiroRandomSource::Next(int range)
+{
+	return NextInRange((uint32_t)range);
+}
+
+
+void XoshiroRandomSource::Fill(int range, int* out, size_t n)
+{
+	for (size_t i = 0; i < n; i++)
+		out[i] = NextInRange((uint32_t)range);
+}
+
+
+void XoshiroRandomSource::Jump()
+{
+	static const uint64_t jump[4] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+		0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+	uint64_t state[4] = {0, 0, 0, 0};
+	for (int i = 0; i < 4; i++)
+	{
+		for (int bit = 0; bit < 64; bit++)
+		{
+			if (jump[i] & (1ULL << bit))
+			{
+				for (int j = 0; j < 4; j++)
+					state[j] ^= m_state[j];
+			}
+			NextValue();
+		}
+	}
+	for (int i = 0; i < 4; i++)
+		m_state[i] = state[i];
 }
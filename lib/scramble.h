@@ -1,12 +1,17 @@
 #pragma once
 
 #include <string>
+#include <atomic>
 #include "cubecommon.h"
 
 class RandomSource
 {
 public:
 	virtual int Next(int range) = 0;
+
+	// Fills the output with values in the range, which is the same as calling Next for each value.
+	// Sources should override this to avoid the call overhead for each value.
+	virtual void Fill(int range, int* out, size_t n);
 };
 
 // Do not use this for scrambles, this is here for deterministic unit tests.
@@ -20,11 +25,49 @@ public:
 	virtual int Next(int range) override;
 };
 
+// Fast seeded source using the xoshiro256** generator. Bounded values use Lemire's multiply and
+// reject method, so there is no modulo bias. The output is good statistically, but it is not a
+// cryptographic generator. Jump advances the stream by 2**128 values, so independent streams for
+// each thread can be made from the same seed and remain reproducible.
+class XoshiroRandomSource: public RandomSource
+{
+	uint64_t m_state[4];
+
+	inline uint64_t NextValue();
+	inline int NextInRange(uint32_t range);
+
+public:
+	XoshiroRandomSource(uint64_t seed);
+	virtual int Next(int range) override;
+	virtual void Fill(int range, int* out, size_t n) override;
+	void Jump();
+};
+
+// Used to cancel a long running operation, such as a solve, from another thread
+class CancellationToken
+{
+	std::atomic<bool> m_cancelled;
+
+public:
+	CancellationToken(): m_cancelled(false) {}
+	void Cancel() { m_cancelled.store(true, std::memory_order_relaxed); }
+	void Reset() { m_cancelled.store(false, std::memory_order_relaxed); }
+	bool IsCancelled() const { return m_cancelled.load(std::memory_order_relaxed); }
+};
+
 class Scrambler
 {
 public:
 	virtual ~Scrambler() {}
 	virtual std::string GetName() = 0;
 	virtual CubeMoveSequence GetScramble(RandomSource& rng) = 0;
+
+	// Scramblers that take a long time should override this to stop early when cancelled. An
+	// empty sequence is returned if the scramble was cancelled or could not be generated.
+	virtual CubeMoveSequence GetScramble(RandomSource& rng, const CancellationToken& cancel)
+	{
+		(void)cancel;
+		return GetScramble(rng);
+	}
 	virtual size_t GetMaxMoveCount() = 0;
 };
@@ -0,0 +1,269 @@
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#elif defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include "scramblepool.h"
+
+using namespace std;
+
+static mutex g_scramblePoolFileMutex;
+static string g_scramblePoolFilePath;
+
+
+static void SetCurrentThreadLowPriority()
+{
+#ifdef _WIN32
+	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#elif defined(__APPLE__)
+	pthread_set_qos_class_self_np(QOS_CLASS_UTILITY, 0);
+#elif defined(__linux__)
+	// Linux keeps a nice value for each thread, so this only affects the calling thread
+	setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), 19);
+#endif
+}
+
+
+// Reads the lines of a pool file, each of which is a scrambler name and a scramble separated by
+// a tab. Returns false if the file could not be opened.
+static bool ReadPoolFile(const string& path, vector<pair<string, string>>& entries)
+{
+	FILE* fp = fopen(path.c_str(), "r");
+	if (!fp)
+		return false;
+
+	char line[1024];
+	while (fgets(line, sizeof(line), fp))
+	{
+		line[strcspn(line, "\r\n")] = 0;
+		char* separator = strchr(line, '\t');
+		if (!separator)
+			continue;
+		*separator = 0;
+		entries.push_back(pair<string, string>(line, separator + 1));
+	}
+	fclose(fp);
+	return true;
+}
+
+
+static bool WritePoolFile(const string& path, const vector<pair<string, string>>& entries)
+{
+	FILE* fp = fopen(path.c_str(), "w");
+	if (!fp)
+		return false;
+	bool ok = true;
+	for (auto& i : entries)
+	{
+		if (fprintf(fp, "%s\t%s\n", i.first.c_str(), i.second.c_str()) < 0)
+			ok = false;
+	}
+	if (fclose(fp) != 0)
+		ok = false;
+	return ok;
+}
+
+
+ScramblePool::ScramblePool(const shared_ptr<Scrambler>& scrambler, const shared_ptr<RandomSource>& rng,
+	size_t size): m_scrambler(scrambler), m_rng(rng), m_size(size), m_running(false), m_failed(false)
+{
+}
+
+
+ScramblePool::~ScramblePool()
+{
+	Stop();
+}
+
+
+void ScramblePool::SetFilePath(const string& path)
+{
+	lock_guard<mutex> lock(g_scramblePoolFileMutex);
+	g_scramblePoolFilePath = path;
+}
+
+
+void ScramblePool::SetReadyCallback(const function<void()>& callback)
+{
+	lock_guard<mutex> lock(m_mutex);
+	m_readyCallback = callback;
+}
+
+
+void ScramblePool::Start()
+{
+	if (m_thread.joinable())
+		return;
+
+	string path;
+	{
+		lock_guard<mutex> lock(g_scramblePoolFileMutex);
+		path = g_scramblePoolFilePath;
+	}
+	if (path.size() != 0)
+		Load(path);
+
+	m_running = true;
+	m_failed = false;
+	m_cancel.Reset();
+	m_thread = thread([this]() { Refill(); });
+}
+
+
+void ScramblePool::Stop()
+{
+	if (!m_thread.joinable())
+		return;
+
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_running = false;
+		m_cancel.Cancel();
+		m_cond.notify_all();
+	}
+	m_thread.join();
+
+	string path;
+	{
+		lock_guard<mutex> lock(g_scramblePoolFileMutex);
+		path = g_scramblePoolFilePath;
+	}
+	if (path.size() != 0)
+		Save(path);
+}
+
+
+void ScramblePool::Refill()
+{
+	SetCurrentThreadLowPriority();
+
+	unique_lock<mutex> lock(m_mutex);
+	while (m_running)
+	{
+		if (m_ready.size() >= m_size)
+		{
+			m_cond.wait(lock);
+			continue;
+		}
+
+		lock.unlock();
+		CubeMoveSequence scramble = m_scrambler->GetScramble(*m_rng, m_cancel);
+		lock.lock();
+
+		if (!m_running)
+			continue;
+		if (scramble.moves.size() == 0)
+		{
+			// The scrambler returned nothing without being cancelled, so it can't generate
+			// scrambles. Wake up anything waiting for a scramble and stop refilling.
+			m_failed = true;
+			m_cond.notify_all();
+			break;
+		}
+		m_ready.push_back(scramble);
+		m_cond.notify_all();
+
+		function<void()> callback = m_readyCallback;
+		if (callback)
+		{
+			lock.unlock();
+			callback();
+			lock.lock();
+		}
+	}
+}
+
+
+bool ScramblePool::TryGetScramble(CubeMoveSequence& scramble)
+{
+	lock_guard<mutex> lock(m_mutex);
+	if (m_ready.size() == 0)
+		return false;
+	scramble = m_ready.front();
+	m_ready.pop_front();
+	m_cond.notify_all();
+	return true;
+}
+
+
+CubeMoveSequence ScramblePool::GetScramble()
+{
+	unique_lock<mutex> lock(m_mutex);
+	while (m_running && !m_failed && (m_ready.size() == 0))
+		m_cond.wait(lock);
+	if (m_ready.size() == 0)
+		return CubeMoveSequence();
+	CubeMoveSequence result = m_ready.front();
+	m_ready.pop_front();
+	m_cond.notify_all();
+	return result;
+}
+
+
+size_t ScramblePool::GetReadyCount()
+{
+	lock_guard<mutex> lock(m_mutex);
+	return m_ready.size();
+}
+
+
+bool ScramblePool::Load(const string& path)
+{
+	// Scrambles are removed from the file as they are loaded, so that they are not used again if
+	// the app exits without stopping the pool, or by another pool for the same scrambler
+	string name = m_scrambler->GetName();
+	lock_guard<mutex> fileLock(g_scramblePoolFileMutex);
+	vector<pair<string, string>> entries;
+	if (!ReadPoolFile(path, entries))
+		return false;
+
+	vector<pair<string, string>> remaining;
+	{
+		lock_guard<mutex> lock(m_mutex);
+		for (auto& i : entries)
+		{
+			if ((i.first != name) || (m_ready.size() >= m_size))
+			{
+				remaining.push_back(i);
+				continue;
+			}
+			CubeMoveSequence scramble;
+			if (!CubeMoveSequence::FromString(i.second, scramble) || (scramble.moves.size() == 0))
+				continue;
+			m_ready.push_back(scramble);
+		}
+		m_cond.notify_all();
+	}
+
+	if (remaining.size() != entries.size())
+		return WritePoolFile(path, remaining);
+	return true;
+}
+
+
+bool ScramblePool::Save(const string& path)
+{
+	string name = m_scrambler->GetName();
+	lock_guard<mutex> fileLock(g_scramblePoolFileMutex);
+	vector<pair<string, string>> entries;
+	ReadPoolFile(path, entries);
+
+	// Saved scrambles are moved to the file, so that they are not also handed out from memory if
+	// the pool is started again
+	lock_guard<mutex> lock(m_mutex);
+	for (auto& i : m_ready)
+		entries.push_back(pair<string, string>(name, i.ToString()));
+	if (!WritePoolFile(path, entries))
+		return false;
+	m_ready.clear();
+	m_cond.notify_all();
+	return true;
+}
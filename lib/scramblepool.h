@@ -0,0 +1,68 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "scramble.h"
+
+#define SCRAMBLE_POOL_DEFAULT_SIZE 8
+
+// Keeps a number of scrambles from a scrambler ready ahead of time, so that a new scramble is
+// available immediately instead of waiting on the scrambler. The pool is refilled on a low
+// priority background thread whenever a scramble is taken. If a file path is set, the ready
+// scrambles are saved when the pool is stopped and loaded again when the next pool for the
+// same scrambler is started, so that the first scramble after startup is also immediate.
+// Loaded scrambles are removed from the file, so each saved scramble is only used once.
+class ScramblePool
+{
+	std::shared_ptr<Scrambler> m_scrambler;
+	std::shared_ptr<RandomSource> m_rng;
+	size_t m_size;
+	std::deque<CubeMoveSequence> m_ready;
+	std::function<void()> m_readyCallback;
+
+	std::mutex m_mutex;
+	std::condition_variable m_cond;
+	std::thread m_thread;
+	bool m_running;
+	bool m_failed;
+	CancellationToken m_cancel;
+
+	void Refill();
+
+public:
+	// The random source is only used from the background thread
+	ScramblePool(const std::shared_ptr<Scrambler>& scrambler, const std::shared_ptr<RandomSource>& rng,
+		size_t size = SCRAMBLE_POOL_DEFAULT_SIZE);
+	~ScramblePool();
+
+	// Sets the file that pools are loaded from on start and saved to on stop. Pools for different
+	// scramblers share the file.
+	static void SetFilePath(const std::string& path);
+
+	// Called from the background thread each time a new scramble is ready
+	void SetReadyCallback(const std::function<void()>& callback);
+
+	void Start();
+	void Stop();
+
+	// Takes the next ready scramble. Returns false if there are none ready yet.
+	bool TryGetScramble(CubeMoveSequence& scramble);
+
+	// Waits for the next ready scramble. An empty sequence is returned if the pool is stopped or
+	// the scrambler could not generate a scramble.
+	CubeMoveSequence GetScramble();
+
+	size_t GetReadyCount();
+	const std::shared_ptr<Scrambler>& GetScrambler() const { return m_scrambler; }
+
+	// Takes up to the pool size of this scrambler's scrambles from the file, removing them from it
+	bool Load(const std::string& path);
+
+	// Moves the ready scrambles to the file, keeping the scrambles already in it
+	bool Save(const std::string& path);
+};
@@ -0,0 +1,263 @@
+#include "../lib/cube3x3.cpp"
+#include "../lib/cube3x3cache.cpp"
+#include "../lib/cube3x3facesavx2.cpp"
+#include "../lib/cube3x3optimal.cpp"
+#include "../lib/cube3x3packed.cpp"
+#include "../lib/cube3x3tables.cpp"
+#include "../lib/cubecommon.cpp"
+#include "../lib/scramble.cpp"
+#include <math.h>
+#include <map>
+
+using namespace std;
+
+struct BenchResult
+{
+	string mode;
+	vector<double> latencies;
+	map<size_t, size_t> lengths;
+	uint64_t nodes = 0;
+	bool hasNodes = false;
+	size_t failures = 0;
+};
+
+
+static double Percentile(const vector<double>& sorted, double fraction)
+{
+	// Nearest rank percentile
+	if (sorted.empty())
+		return 0;
+	size_t rank = (size_t)ceil(fraction * sorted.size());
+	if (rank > 0)
+		rank--;
+	return sorted[min(rank, sorted.size() - 1)];
+}
+
+
+static uint64_t TotalNodes(const Cube3x3SolveStats& stats)
+{
+	uint64_t result = stats.endgameNodes;
+	for (size_t i = 0; i <= MAX_3X3_SOLUTION_MOVES; i++)
+		result += stats.phase1Nodes[i] + stats.phase2Nodes[i];
+	return result;
+}
+
+
+static BenchResult RunMode(const string& mode, const vector<Cube3x3>& corpus)
+{
+	BenchResult result;
+	result.mode = mode;
+#ifdef CUBE3X3_SOLVE_STATS
+	result.hasNodes = mode != "korf";
+#endif
+
+	Cube3x3Solver solver;
+	CubeMoveSequence solution;
+	for (size_t i = 0; i < corpus.size(); i++)
+	{
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		if (mode == "fast")
+			solver.Solve(corpus[i], solution, false);
+		else if (mode == "optimal")
+			solver.Solve(corpus[i], solution, true);
+		else
+			solution = Cube3x3OptimalSolver::Solve(corpus[i], 1);
+		chrono::steady_clock::time_point end = chrono::steady_clock::now();
+
+		result.latencies.push_back(chrono::duration<double, milli>(end - start).count());
+		if (result.hasNodes)
+			result.nodes += TotalNodes(solver.GetLastSolveStats());
+
+		Cube3x3 cube = corpus[i];
+		for (auto j : solution.moves)
+			cube.Move(j);
+		if (!cube.IsSolved())
+			result.failures++;
+		result.lengths[solution.moves.size()]++;
+
+		if (((i + 1) % 100) == 0)
+			fprintf(stderr, "%s: %d / %d\r", mode.c_str(), (int)(i + 1), (int)corpus.size());
+	}
+	fprintf(stderr, "%s: %d / %d\n", mode.c_str(), (int)corpus.size(), (int)corpus.size());
+	return result;
+}
+
+
+// Measures the number of moves per second for a cube representation
+template <class T>
+static double MoveThroughput(const vector<CubeMove>& moves)
+{
+	T cube;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for (auto i : moves)
+		cube.Move(i);
+	chrono::steady_clock::time_point end = chrono::steady_clock::now();
+
+	// Use the result so that the moves are not optimized out
+	if (cube.IsSolved())
+		fprintf(stderr, "Cube solved after move sequence\n");
+	return moves.size() / chrono::duration<double>(end - start).count();
+}
+
+
+static void PrintResult(const BenchResult& result, bool last)
+{
+	vector<double> sorted = result.latencies;
+	sort(sorted.begin(), sorted.end());
+	double total = 0;
+	for (auto i : sorted)
+		total += i;
+
+	printf("\t\t{\n");
+	printf("\t\t\t\"mode\": \"%s\",\n", result.mode.c_str());
+	printf("\t\t\t\"solves\": %d,\n", (int)sorted.size());
+	printf("\t\t\t\"failures\": %d,\n", (int)result.failures);
+	printf("\t\t\t\"total_ms\": %.3f,\n", total);
+	printf("\t\t\t\"latency_ms\": {\"mean\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f},\n",
+		sorted.empty() ? 0 : (total / sorted.size()), Percentile(sorted, 0.5), Percentile(sorted, 0.9),
+		Percentile(sorted, 0.99), sorted.empty() ? 0 : sorted.back());
+	if (result.hasNodes)
+	{
+		printf("\t\t\t\"nodes\": %llu,\n", (unsigned long long)result.nodes);
+		printf("\t\t\t\"nodes_per_sec\": %.0f,\n", (total > 0) ? (result.nodes * 1000.0 / total) : 0.0);
+	}
+	else
+	{
+		printf("\t\t\t\"nodes\": null,\n");
+		printf("\t\t\t\"nodes_per_sec\": null,\n");
+	}
+
+	printf("\t\t\t\"lengths\": {");
+	bool first = true;
+	for (auto& i : result.lengths)
+	{
+		printf("%s\"%d\": %d", first ? "" : ", ", (int)i.first, (int)i.second);
+		first = false;
+	}
+	printf("}\n");
+	printf("\t\t}%s\n", last ? "" : ",");
+}
+
+
+// Solves a fixed corpus of random cube states with each solver mode and prints the results as
+// JSON, so that solver performance can be compared between builds. Modes are "fast" (first
+// solution found), "optimal" (two phase search for the shortest solution), and "korf" (the
+// optimal IDA* solver, which is very slow for random states, so use it with a small count).
+// The number of moves per second for each cube format is also reported. Node counts are only
+// reported when built with the CUBE3X3_SOLVE_STATS option, which slows down solves, so compare
+// latencies between builds without it.
+int main(int argc, char* argv[])
+{
+	size_t count = 10000;
+	uint32_t seed = 1;
+	string tablePath = "tpscube3x3.tables";
+	string optimalTablePath = "tpscube3x3optimal.tables";
+	vector<string> modes = {"fast", "optimal"};
+	size_t moveCount = 10000000;
+
+	for (int i = 1; i < argc; i++)
+	{
+		string arg = argv[i];
+		if ((i + 1) >= argc)
+		{
+			fprintf(stderr, "Missing value for %s\n", arg.c_str());
+			return 1;
+		}
+		string value = argv[++i];
+		if (arg == "--count")
+			count = (size_t)strtoull(value.c_str(), nullptr, 10);
+		else if (arg == "--seed")
+			seed = (uint32_t)strtoul(value.c_str(), nullptr, 10);
+		else if (arg == "--moves")
+			moveCount = (size_t)strtoull(value.c_str(), nullptr, 10);
+		else if (arg == "--tables")
+			tablePath = value;
+		else if (arg == "--optimal-tables")
+			optimalTablePath = value;
+		else if (arg == "--modes")
+		{
+			modes.clear();
+			size_t start = 0;
+			while (start <= value.size())
+			{
+				size_t end = value.find(',', start);
+				if (end == string::npos)
+					end = value.size();
+				modes.push_back(value.substr(start, end - start));
+				start = end + 1;
+			}
+		}
+		else
+		{
+			fprintf(stderr, "Usage: %s [--count N] [--seed S] [--modes fast,optimal,korf] "
+				"[--moves N] [--tables path] [--optimal-tables path]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	for (auto& i : modes)
+	{
+		if ((i != "fast") && (i != "optimal") && (i != "korf"))
+		{
+			fprintf(stderr, "Unknown mode %s\n", i.c_str());
+			return 1;
+		}
+	}
+
+	// Load the tables before timing anything, so that table generation is not included
+	Cube3x3::SetTableFilePath(tablePath);
+	if (!Cube3x3::LoadTables())
+	{
+		fprintf(stderr, "Failed to load solver tables\n");
+		return 1;
+	}
+	if (find(modes.begin(), modes.end(), "korf") != modes.end())
+	{
+		Cube3x3OptimalSolver::SetTableFilePath(optimalTablePath);
+		if (!Cube3x3OptimalSolver::LoadTables())
+		{
+			fprintf(stderr, "Failed to load optimal solver tables\n");
+			return 1;
+		}
+	}
+
+	SimpleSeededRandomSource rng(seed);
+	vector<Cube3x3> corpus(count);
+	for (auto& i : corpus)
+		i.GenerateRandomState(rng);
+
+	vector<BenchResult> results;
+	for (auto& i : modes)
+		results.push_back(RunMode(i, corpus));
+
+	vector<int> moveValues(moveCount);
+	rng.Fill(MOVE_D2 + 1, moveValues.data(), moveCount);
+	vector<CubeMove> moves(moveCount);
+	for (size_t i = 0; i < moveCount; i++)
+		moves[i] = (CubeMove)moveValues[i];
+	double pieceMoveRate = MoveThroughput<Cube3x3>(moves);
+	double faceMoveRate = MoveThroughput<Cube3x3Faces>(moves);
+	double packedMoveRate = MoveThroughput<Cube3x3Packed>(moves);
+
+	printf("{\n");
+	printf("\t\"seed\": %u,\n", seed);
+	printf("\t\"count\": %d,\n", (int)count);
+#ifdef CUBE3X3_SOLVE_STATS
+	printf("\t\"solve_stats\": true,\n");
+#else
+	printf("\t\"solve_stats\": false,\n");
+#endif
+	printf("\t\"moves_per_sec\": {\"pieces\": %.0f, \"faces\": %.0f, \"packed\": %.0f},\n", pieceMoveRate,
+		faceMoveRate, packedMoveRate);
+	printf("\t\"results\": [\n");
+	bool failed = false;
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		PrintResult(results[i], (i + 1) == results.size());
+		if (results[i].failures != 0)
+			failed = true;
+	}
+	printf("\t]\n");
+	printf("}\n");
+	return failed ? 1 : 0;
+}
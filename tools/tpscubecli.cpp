@@ -0,0 +1,338 @@
+#include "../lib/cube3x3.cpp"
+#include "../lib/cube3x3cache.cpp"
+#include "../lib/cube3x3facesavx2.cpp"
+#include "../lib/cube3x3optimal.cpp"
+#include "../lib/cube3x3tables.cpp"
+#include "../lib/cubecommon.cpp"
+#include "../lib/scramble.cpp"
+#include <iostream>
+#include <random>
+
+using namespace std;
+
+// Number of cubes handed to the batch solver at once for each thread. Results are written after
+// each batch, so this trades off streaming latency against idle threads at the end of a batch.
+#define CUBES_PER_THREAD_PER_BATCH 64
+
+struct Options
+{
+	size_t count = 0;
+	size_t threadCount = 0;
+	bool seeded = false;
+	uint32_t seed = 0;
+	bool optimal = true;
+	string tablePath = "tpscube3x3.tables";
+};
+
+
+static void Usage(const char* name)
+{
+	fprintf(stderr, "Usage:\n");
+	fprintf(stderr, "  %s scramble [--count N] [--threads T] [--seed S] [--fast] [--tables path]\n", name);
+	fprintf(stderr, "      Writes N random state 3x3 scrambles, one per line. With a seed, the output is\n");
+	fprintf(stderr, "      the same for any number of threads.\n");
+	fprintf(stderr, "  %s solve [--threads T] [--fast] [--tables path]\n", name);
+	fprintf(stderr, "      Reads one cube per line from stdin and writes a solution for each. A line is\n");
+	fprintf(stderr, "      either a move sequence to apply to a solved cube, or 54 colors (W, G, R, B, O, Y)\n");
+	fprintf(stderr, "      for the top, front, right, back, left and bottom faces, each row by row.\n");
+	fprintf(stderr, "  %s bench [--count N] [--threads T] [--seed S] [--fast] [--tables path]\n", name);
+	fprintf(stderr, "      Solves N random states on one thread and on T threads and reports the rates.\n");
+	fprintf(stderr, "A thread count of zero uses all available cores. Solves are optimal for the two phase\n");
+	fprintf(stderr, "solver unless --fast is given, which returns the first solution found.\n");
+}
+
+
+static bool ParseOptions(int argc, char* argv[], Options& options)
+{
+	for (int i = 2; i < argc; i++)
+	{
+		string arg = argv[i];
+		if (arg == "--fast")
+		{
+			options.optimal = false;
+			continue;
+		}
+
+		if ((i + 1) >= argc)
+		{
+			fprintf(stderr, "Missing value for %s\n", arg.c_str());
+			return false;
+		}
+		string value = argv[++i];
+		if (arg == "--count")
+			options.count = (size_t)strtoull(value.c_str(), nullptr, 10);
+		else if (arg == "--threads")
+			options.threadCount = (size_t)strtoull(value.c_str(), nullptr, 10);
+		else if (arg == "--seed")
+		{
+			options.seeded = true;
+			options.seed = (uint32_t)strtoul(value.c_str(), nullptr, 10);
+		}
+		else if (arg == "--tables")
+			options.tablePath = value;
+		else
+		{
+			fprintf(stderr, "Unknown option %s\n", arg.c_str());
+			return false;
+		}
+	}
+	return true;
+}
+
+
+static size_t GetBatchSize(const Options& options)
+{
+	size_t threadCount = options.threadCount;
+	if (threadCount == 0)
+		threadCount = thread::hardware_concurrency();
+	if (threadCount == 0)
+		threadCount = 1;
+	return threadCount * CUBES_PER_THREAD_PER_BATCH;
+}
+
+
+static bool PrepareTables(const Options& options)
+{
+	Cube3x3::SetTableFilePath(options.tablePath);
+	if (!Cube3x3::LoadTables())
+	{
+		fprintf(stderr, "Failed to load solver tables\n");
+		return false;
+	}
+	return true;
+}
+
+
+// Checks that a cube built from face colors is a real cube state. Converting the pieces back to
+// face colors catches colors that do not form a piece, and each piece must appear exactly once
+// with the orientation and permutation parity of a cube that can be solved.
+static bool IsSolvableState(const Cube3x3Faces& faces, const Cube3x3& cube)
+{
+	if (!(Cube3x3Faces(cube) == faces))
+		return false;
+
+	uint32_t cornersSeen = 0, edgesSeen = 0;
+	int cornerOrientation = 0, edgeOrientation = 0;
+	int inversions = 0;
+	for (int i = 0; i < 8; i++)
+	{
+		const CubePiece& piece = cube.Corner((CubeCorner)i);
+		cornersSeen |= 1 << piece.piece;
+		cornerOrientation += piece.orientation;
+		for (int j = i + 1; j < 8; j++)
+			inversions += (piece.piece > cube.Corner((CubeCorner)j).piece) ? 1 : 0;
+	}
+	for (int i = 0; i < 12; i++)
+	{
+		const CubePiece& piece = cube.Edge((CubeEdge)i);
+		edgesSeen |= 1 << piece.piece;
+		edgeOrientation += piece.orientation;
+		for (int j = i + 1; j < 12; j++)
+			inversions += (piece.piece > cube.Edge((CubeEdge)j).piece) ? 1 : 0;
+	}
+	return (cornersSeen == 0xff) && (edgesSeen == 0xfff) && ((cornerOrientation % 3) == 0) &&
+		((edgeOrientation % 2) == 0) && ((inversions % 2) == 0);
+}
+
+
+static bool ParseCube(const string& line, Cube3x3& cube)
+{
+	static const char colorNames[] = "WGRBOY";
+	if ((line.size() == 54) && (line.find_first_not_of(colorNames) == string::npos))
+	{
+		Cube3x3Faces faces;
+		for (size_t i = 0; i < 54; i++)
+		{
+			faces.SetColor((CubeFace)(i / 9), (i / 3) % 3, i % 3,
+				(CubeColor)(strchr(colorNames, line[i]) - colorNames));
+		}
+		cube = Cube3x3(faces);
+		return IsSolvableState(faces, cube);
+	}
+
+	CubeMoveSequence moves;
+	if (!CubeMoveSequence::FromString(line, moves))
+		return false;
+	cube = Cube3x3();
+	cube.Apply(moves);
+	return true;
+}
+
+
+static int Scramble(const Options& options)
+{
+	if (!PrepareTables(options))
+		return 1;
+
+	// States are drawn in order from a single source, so a seeded run gives the same states no
+	// matter how many threads solve them. Scrambles are the inverse of the solution.
+	random_device device;
+	XoshiroRandomSource rng(options.seeded ? options.seed : (((uint64_t)device() << 32) | device()));
+	Cube3x3BatchSolveOptions solveOptions;
+	solveOptions.optimal = options.optimal;
+	solveOptions.threadCount = options.threadCount;
+	size_t batchSize = GetBatchSize(options);
+
+	size_t count = (options.count == 0) ? 1 : options.count;
+	for (size_t written = 0; written < count; )
+	{
+		vector<Cube3x3> cubes(min(batchSize, count - written));
+		for (auto& i : cubes)
+			i.GenerateRandomState(rng);
+
+		vector<CubeMoveSequence> solutions = Cube3x3::SolveBatch(cubes, solveOptions);
+		for (auto& i : solutions)
+		{
+			// Skip states that are too close to solved to be a reasonable scramble, in the same way
+			// as the random state scrambler
+			if (i.moves.size() < 4)
+				continue;
+			printf("%s\n", i.Inverted().ToString().c_str());
+			written++;
+		}
+		fflush(stdout);
+	}
+	return 0;
+}
+
+
+static int Solve(const Options& options)
+{
+	if (!PrepareTables(options))
+		return 1;
+
+	Cube3x3BatchSolveOptions solveOptions;
+	solveOptions.optimal = options.optimal;
+	solveOptions.threadCount = options.threadCount;
+	size_t batchSize = GetBatchSize(options);
+
+	// Solve the input in batches, writing the solutions for each batch in the order of the input
+	// lines. Lines that are not valid cubes are written as ERROR so that the output lines still
+	// match the input lines.
+	bool failed = false;
+	size_t lineNumber = 0;
+	string line;
+	bool done = false;
+	while (!done)
+	{
+		vector<Cube3x3> cubes;
+		vector<bool> valid;
+		while (cubes.size() < batchSize)
+		{
+			// Read whole lines of any length, so that each input line gives exactly one output line
+			if (!getline(cin, line))
+			{
+				done = true;
+				break;
+			}
+			lineNumber++;
+			if ((line.size() != 0) && (line.back() == '\r'))
+				line.pop_back();
+
+			Cube3x3 cube;
+			bool ok = ParseCube(line, cube);
+			if (!ok)
+			{
+				fprintf(stderr, "Line %d is not a valid cube\n", (int)lineNumber);
+				failed = true;
+			}
+			// Invalid lines may not be real cube states, which the solver cannot handle, so solve a
+			// solved cube in their place to keep the output in step with the input
+			cubes.push_back(ok ? cube : Cube3x3());
+			valid.push_back(ok);
+		}
+
+		vector<CubeMoveSequence> solutions = Cube3x3::SolveBatch(cubes, solveOptions);
+		for (size_t i = 0; i < solutions.size(); i++)
+			printf("%s\n", valid[i] ? solutions[i].ToString().c_str() : "ERROR");
+		fflush(stdout);
+	}
+	return failed ? 1 : 0;
+}
+
+
+static double SolveRate(const vector<Cube3x3>& cubes, Cube3x3BatchSolveOptions solveOptions, size_t threadCount,
+	bool& failed)
+{
+	solveOptions.threadCount = threadCount;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	vector<CubeMoveSequence> solutions = Cube3x3::SolveBatch(cubes, solveOptions);
+	chrono::steady_clock::time_point end = chrono::steady_clock::now();
+
+	for (size_t i = 0; i < cubes.size(); i++)
+	{
+		Cube3x3 cube = cubes[i];
+		cube.Apply(solutions[i]);
+		if (!cube.IsSolved())
+			failed = true;
+	}
+	return cubes.size() / chrono::duration<double>(end - start).count();
+}
+
+
+static int Bench(const Options& options)
+{
+	if (!PrepareTables(options))
+		return 1;
+
+	size_t count = (options.count == 0) ? 200 : options.count;
+	XoshiroRandomSource rng(options.seeded ? options.seed : 1);
+	vector<Cube3x3> cubes(count);
+	for (auto& i : cubes)
+		i.GenerateRandomState(rng);
+
+	size_t threadCount = options.threadCount;
+	if (threadCount == 0)
+		threadCount = thread::hardware_concurrency();
+	if (threadCount == 0)
+		threadCount = 1;
+
+	Cube3x3BatchSolveOptions solveOptions;
+	solveOptions.optimal = options.optimal;
+	bool failed = false;
+	double singleRate = SolveRate(cubes, solveOptions, 1, failed);
+	double parallelRate = SolveRate(cubes, solveOptions, threadCount, failed);
+
+	printf("{\n");
+	printf("\t\"count\": %d,\n", (int)count);
+	printf("\t\"mode\": \"%s\",\n", options.optimal ? "optimal" : "fast");
+	printf("\t\"threads\": %d,\n", (int)threadCount);
+	printf("\t\"solves_per_sec_single\": %.1f,\n", singleRate);
+	printf("\t\"solves_per_sec\": %.1f,\n", parallelRate);
+	printf("\t\"speedup\": %.2f,\n", (singleRate > 0) ? (parallelRate / singleRate) : 0.0);
+	printf("\t\"failures\": %s\n", failed ? "true" : "false");
+	printf("}\n");
+	return failed ? 1 : 0;
+}
+
+
+// Command line tool for generating scrambles and solving cubes in bulk. This only uses the cube
+// library, so it can run on machines without a display or Qt.
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		Usage(argv[0]);
+		return 1;
+	}
+
+	Options options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		Usage(argv[0]);
+		return 1;
+	}
+
+	// Input is only read through cin, so it does not need to stay in sync with stdio
+	ios::sync_with_stdio(false);
+
+	string command = argv[1];
+	if (command == "scramble")
+		return Scramble(options);
+	if (command == "solve")
+		return Solve(options);
+	if (command == "bench")
+		return Bench(options);
+	Usage(argv[0]);
+	return 1;
+}
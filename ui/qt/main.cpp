@@ -9,10 +9,19 @@
 #include <QtCore/QDir>
 #include <QtCore/QUuid>
 #include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
 #include <vector>
+#include <thread>
+#include <atomic>
+#include <new>
 #include "mainwindow.h"
 #include "theme.h"
 #include "cube3x3.h"
+#include "cube3x3cache.h"
+#include "cube3x3optimal.h"
+#include "cube3x3packed.h"
+#include "scramblepool.h"
 #include "history.h"
 #include "bluetoothcube.h"
 
@@ -29,6 +38,41 @@ public:
 };
 
 
+#ifdef TPSCUBE_COUNT_ALLOCATIONS
+// Count all heap allocations so that tests can verify code paths that should not allocate. This
+// replaces the global allocator, so it is only enabled in test builds.
+#ifdef __GNUC__
+// Inlining these into callers makes GCC warn that memory from new is passed to free
+#define ALLOCATOR_FUNCTION __attribute__((noinline))
+#else
+#define ALLOCATOR_FUNCTION
+#endif
+
+static atomic<size_t> g_allocationCount(0);
+
+ALLOCATOR_FUNCTION void* operator new(size_t size)
+{
+	g_allocationCount.fetch_add(1, memory_order_relaxed);
+	void* result = malloc(size ? size : 1);
+	if (!result)
+		throw bad_alloc();
+	return result;
+}
+
+
+ALLOCATOR_FUNCTION void operator delete(void* ptr) noexcept
+{
+	free(ptr);
+}
+
+
+ALLOCATOR_FUNCTION void operator delete(void* ptr, size_t) noexcept
+{
+	free(ptr);
+}
+#endif
+
+
 #define EXPECT(test, msg, dbg) \
 	{ \
 		fprintf(stderr, "%s... ", string(msg).c_str()); \
@@ -134,6 +178,113 @@ int Cube3x3MatchTest()
 		fprintf(stderr, "Faces converted to pieces format:\n");
 		Cube3x3Faces(facesConverted).PrintDebugState();
 	});
+
+	// Colors that do not form pieces must not survive conversion to pieces and back, which is how
+	// tpscube-cli rejects them before they reach the solver
+	Cube3x3Faces white;
+	for (int i = 0; i < 6 * 9; i++)
+		white.SetColor((CubeFace)(i / 9), (i / 3) % 3, i % 3, WHITE);
+	EXPECT(!(Cube3x3Faces(Cube3x3(white)) == white), "3x3 format match: Single color state is not a cube",
+		Cube3x3Faces(Cube3x3(white)).PrintDebugState());
+	return 0;
+}
+
+
+int Cube3x3FacesScalarTest()
+{
+	// Move, IsSolved, and operator== are vectorized when the CPU supports AVX2. Check that they
+	// agree with the scalar versions that are used otherwise.
+	SimpleSeededRandomSource rng;
+	Cube3x3Faces cube, scalar;
+	CubeMove move;
+	EXPECT_REPEAT((move = CubeMoveSequence::RandomMove(rng), cube.Move(move), scalar.MoveScalar(move),
+		cube.EqualsScalar(scalar)), 10000, "3x3 faces: Random moves match scalar moves",
+		(cube.PrintDebugState(), scalar.PrintDebugState()));
+
+	CubeMoveSequence moves;
+	for (size_t i = 0; i < 1000; i++)
+		moves.moves.push_back(CubeMoveSequence::RandomMove(rng));
+	cube.Apply(moves);
+	for (auto i : moves.moves)
+		scalar.MoveScalar(i);
+	EXPECT(cube.EqualsScalar(scalar), "3x3 faces: Applied sequence matches scalar moves",
+		(cube.PrintDebugState(), scalar.PrintDebugState()));
+
+	// Check solved states, states one move from solved, and states with a single wrong color
+	Cube3x3Faces solved;
+	EXPECT(solved.IsSolved() && solved.IsSolvedScalar(), "3x3 faces: Solved state matches scalar", );
+	EXPECT_REPEAT((cube = solved, cube.Move((CubeMove)(_i % (MOVE_D2 + 1))),
+		(cube.IsSolved() == cube.IsSolvedScalar()) && ((cube == solved) == cube.EqualsScalar(solved))),
+		MOVE_D2 + 1, "3x3 faces: Single moves match scalar comparisons", cube.PrintDebugState());
+	EXPECT_REPEAT((cube = solved, cube.SetColor((CubeFace)(_i / 9), (_i / 3) % 3, _i % 3,
+		(CubeColor)((solved.GetColor((CubeFace)(_i / 9), (_i / 3) % 3, _i % 3) + 1) % 6)),
+		!cube.IsSolved() && !cube.IsSolvedScalar() && !(cube == solved) && !cube.EqualsScalar(solved) &&
+		(cube == cube)), 6 * 9, "3x3 faces: Single color changes match scalar comparisons", cube.PrintDebugState());
+	EXPECT_REPEAT((cube.Move(CubeMoveSequence::RandomMove(rng)), scalar = cube,
+		scalar.MoveScalar(CubeMoveSequence::RandomMove(rng)),
+		(cube.IsSolved() == cube.IsSolvedScalar()) && ((cube == scalar) == cube.EqualsScalar(scalar))),
+		10000, "3x3 faces: Random states match scalar comparisons", cube.PrintDebugState());
+	return 0;
+}
+
+
+int Cube3x3PackedTest()
+{
+	Cube3x3 pieces;
+	Cube3x3Packed packed;
+	SimpleSeededRandomSource rng;
+	EXPECT(packed.IsSolved() && (packed.ToCube3x3() == pieces), "3x3 packed: Initial state is solved", );
+	EXPECT_REPEAT((pieces.Move((CubeMove)(_i % (MOVE_D2 + 1))), packed.Move((CubeMove)(_i % (MOVE_D2 + 1))),
+		packed.ToCube3x3() == pieces), MOVE_D2 + 1, "3x3 packed: Each move matches piece format",
+		Cube3x3Faces(packed.ToCube3x3()).PrintDebugState());
+	EXPECT_REPEAT((pieces.Move(CubeMoveSequence::RandomMove(rng)), packed = Cube3x3Packed(pieces),
+		packed.ToCube3x3() == pieces), 1000, "3x3 packed: Conversion is lossless", );
+
+	CubeMoveSequence moves;
+	for (size_t i = 0; i < 1000; i++)
+		moves.moves.push_back(CubeMoveSequence::RandomMove(rng));
+	pieces.Apply(moves);
+	packed.Apply(moves);
+	EXPECT(packed.ToCube3x3() == pieces, "3x3 packed: 1000 random moves match piece format",
+		Cube3x3Faces(packed.ToCube3x3()).PrintDebugState());
+	return 0;
+}
+
+
+int RandomSourceTest()
+{
+	XoshiroRandomSource a(1), b(1), c(2);
+	EXPECT_REPEAT(a.Next(1000000) == b.Next(1000000), 1000, "Random: Same seed gives same values", );
+	bool differ = false;
+	for (size_t i = 0; i < 1000; i++)
+		differ = differ || (a.Next(1000000) != c.Next(1000000));
+	EXPECT(differ, "Random: Different seeds give different values", );
+
+	// Fill must give the same values as calling Next
+	XoshiroRandomSource filled(3), single(3);
+	int values[1000];
+	filled.Fill(EDGE_PERMUTATION_INDEX_COUNT / 2, values, 1000);
+	EXPECT_REPEAT(values[_i] == single.Next(EDGE_PERMUTATION_INDEX_COUNT / 2), 1000, "Random: Fill matches Next", );
+	EXPECT_REPEAT((values[_i] >= 0) && (values[_i] < (EDGE_PERMUTATION_INDEX_COUNT / 2)), 1000,
+		"Random: Large range bounds", );
+
+	// Each value in a small range should come up about equally often
+	int counts[3] = {0, 0, 0};
+	a.Fill(3, values, 1000);
+	for (size_t i = 0; i < 1000; i++)
+		counts[values[i]]++;
+	EXPECT((counts[0] > 280) && (counts[1] > 280) && (counts[2] > 280), "Random: Small range distribution",
+		fprintf(stderr, "%d %d %d\n", counts[0], counts[1], counts[2]));
+
+	// Jumped streams must be reproducible and must not overlap the original stream
+	XoshiroRandomSource jumped(1), jumpedAgain(1), original(1);
+	jumped.Jump();
+	jumpedAgain.Jump();
+	EXPECT_REPEAT(jumped.Next(1000000) == jumpedAgain.Next(1000000), 1000, "Random: Jumped streams match", );
+	differ = false;
+	for (size_t i = 0; i < 1000; i++)
+		differ = differ || (jumped.Next(1000000) != original.Next(1000000));
+	EXPECT(differ, "Random: Jumped stream differs from original", );
 	return 0;
 }
 
@@ -160,6 +311,47 @@ int Cube3x3IndexTest()
 	EXPECT_REPEAT((cube.Move(CubeMoveSequence::RandomMove(rng)),
 		cube.GetPhase2EquatorialEdgePermutationIndex() < PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT),
 		10000, "3x3 index: Phase 2 equatorial edge permutation index bounds", Cube3x3Faces(cube).PrintDebugState());
+
+	cube = Cube3x3();
+	EXPECT_REPEAT((cube.SetCornerOrientationIndex(_i), cube.GetCornerOrientationIndex() == _i),
+		CORNER_ORIENTATION_INDEX_COUNT, "3x3 index: Set corner orientation index", Cube3x3Faces(cube).PrintDebugState());
+	EXPECT_REPEAT((cube.SetEdgeOrientationIndex(_i), cube.GetEdgeOrientationIndex() == _i),
+		EDGE_ORIENTATION_INDEX_COUNT, "3x3 index: Set edge orientation index", Cube3x3Faces(cube).PrintDebugState());
+	EXPECT_REPEAT((cube.SetEquatorialEdgeSliceIndex(_i), cube.GetEquatorialEdgeSliceIndex() == _i),
+		EDGE_SLICE_INDEX_COUNT, "3x3 index: Set equatorial edge slice index", Cube3x3Faces(cube).PrintDebugState());
+	EXPECT_REPEAT((cube.SetCornerPermutationIndex(_i), cube.GetCornerPermutationIndex() == _i),
+		CORNER_PERMUTATION_INDEX_COUNT, "3x3 index: Set corner permutation index", Cube3x3Faces(cube).PrintDebugState());
+	EXPECT_REPEAT((cube.SetSortedEdgeIndex(EDGE_UR, _i), cube.GetSortedEdgeIndex(EDGE_UR) == _i),
+		SORTED_EDGE_INDEX_COUNT, "3x3 index: Set sorted edge index", Cube3x3Faces(cube).PrintDebugState());
+
+	cube = Cube3x3();
+	EXPECT_REPEAT((cube.SetPhase2EdgePermutationIndex(_i), cube.GetPhase2EdgePermutationIndex() == _i),
+		PHASE_2_EDGE_PERMUTATION_INDEX_COUNT, "3x3 index: Set phase 2 edge permutation index",
+		Cube3x3Faces(cube).PrintDebugState());
+	EXPECT_REPEAT((cube.SetPhase2EquatorialEdgePermutationIndex(_i), cube.GetPhase2EquatorialEdgePermutationIndex() == _i),
+		PHASE_2_EQUATORIAL_EDGE_PERMUTATION_INDEX_COUNT, "3x3 index: Set phase 2 equatorial edge permutation index",
+		Cube3x3Faces(cube).PrintDebugState());
+
+	// Random states are drawn as coordinates, check that the permutations have matching parity
+	auto parity = [](auto piece, int count) {
+		int inversions = 0;
+		for (int i = 0; i < count; i++)
+			for (int j = i + 1; j < count; j++)
+				inversions += (piece(i) > piece(j)) ? 1 : 0;
+		return inversions & 1;
+	};
+	EXPECT_REPEAT((cube.GenerateRandomState(rng),
+		parity([&](int i) { return cube.Corner((CubeCorner)i).piece; }, 8) ==
+		parity([&](int i) { return cube.Edge((CubeEdge)i).piece; }, 12)),
+		10000, "3x3 index: Random state parity", Cube3x3Faces(cube).PrintDebugState());
+	auto edgesSeen = [&]() {
+		uint32_t seen = 0;
+		for (int i = 0; i < 12; i++)
+			seen |= 1 << cube.Edge((CubeEdge)i).piece;
+		return seen;
+	};
+	EXPECT_REPEAT((cube.GenerateRandomState(rng), edgesSeen() == 0xfff), 10000,
+		"3x3 index: Random state has every edge", Cube3x3Faces(cube).PrintDebugState());
 	return 0;
 }
 
@@ -172,11 +364,16 @@ int Cube3x3SolveTest()
 		Cube3x3 cube;
 		cube.GenerateRandomState(rng);
 
+		Cube3x3Solver solver;
+		CubeMoveSequence solution;
 		std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
-		CubeMoveSequence solution = cube.Solve();
+		solver.Solve(cube, solution);
 		std::chrono::time_point<std::chrono::steady_clock> end = std::chrono::steady_clock::now();
 		int ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
 		fprintf(stderr, "3x3 solve: %d ms for solution in %d moves (%s)\n", ms, (int)solution.moves.size(), solution.ToString().c_str());
+#ifdef CUBE3X3_SOLVE_STATS
+		fprintf(stderr, "%s", solver.GetLastSolveStats().ToString().c_str());
+#endif
 
 		Cube3x3 initial = cube;
 		for (auto j : solution.moves)
@@ -192,6 +389,24 @@ int Cube3x3SolveTest()
 }
 
 
+int Cube3x3RandomStateScrambleTest()
+{
+	// The scrambler draws and solves states in index form, which must give the same states as
+	// GenerateRandomState with the same random values
+	SimpleSeededRandomSource scrambleRng, stateRng;
+	Cube3x3RandomStateScramble scrambler;
+	for (size_t i = 0; i < 10; i++)
+	{
+		Cube3x3 expected, cube;
+		expected.GenerateRandomState(stateRng);
+		cube.Apply(scrambler.GetScramble(scrambleRng));
+		EXPECT(cube == expected, "3x3 random state scramble: Scramble gives the random state",
+			(Cube3x3Faces(expected).PrintDebugState(), Cube3x3Faces(cube).PrintDebugState()));
+	}
+	return 0;
+}
+
+
 int Cube3x3IntermediateSolveTest()
 {
 	SimpleSeededRandomSource rng;
@@ -199,11 +414,13 @@ int Cube3x3IntermediateSolveTest()
 	cube.GenerateRandomState(rng);
 	CubeMoveSequence moves = cube.Solve();
 
+	Cube3x3Solver solver;
+	CubeMoveSequence solution;
 	for (auto i : moves.moves)
 	{
 		std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
 		cube.Move(i);
-		CubeMoveSequence solution = cube.Solve();
+		solver.Solve(cube, solution);
 		std::chrono::time_point<std::chrono::steady_clock> end = std::chrono::steady_clock::now();
 		int ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
 		fprintf(stderr, "3x3 solve: %d ms for solution in %d moves (%s)\n", ms, (int)solution.moves.size(), solution.ToString().c_str());
@@ -223,20 +440,418 @@ int Cube3x3IntermediateSolveTest()
 }
 
 
+int Cube3x3ParallelSolveTest()
+{
+	SimpleSeededRandomSource rng;
+	for (size_t i = 0; i < 10; i++)
+	{
+		Cube3x3 cube;
+		cube.GenerateRandomState(rng);
+
+		CubeMoveSequence serial = cube.Solve(true, 1);
+		std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+		CubeMoveSequence parallel = cube.Solve(true, 4);
+		std::chrono::time_point<std::chrono::steady_clock> end = std::chrono::steady_clock::now();
+		int ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+		fprintf(stderr, "3x3 parallel solve: %d ms for solution in %d moves (%s)\n", ms, (int)parallel.moves.size(), parallel.ToString().c_str());
+
+		if (parallel != serial)
+		{
+			fprintf(stderr, "PARALLEL SOLUTION DOES NOT MATCH (serial %s)\n", serial.ToString().c_str());
+			Cube3x3Faces(cube).PrintDebugState();
+			return 1;
+		}
+	}
+	return 0;
+}
+
+
+int Cube3x3BatchSolveTest()
+{
+	SimpleSeededRandomSource rng;
+	vector<Cube3x3> cubes;
+	vector<CubeMoveSequence> expected;
+	for (size_t i = 0; i < 10; i++)
+	{
+		Cube3x3 cube;
+		cube.GenerateRandomState(rng);
+		cubes.push_back(cube);
+		expected.push_back(cube.Solve());
+	}
+
+	Cube3x3BatchSolveOptions options;
+	options.threadCount = 4;
+	std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+	vector<CubeMoveSequence> solutions = Cube3x3::SolveBatch(cubes, options);
+	std::chrono::time_point<std::chrono::steady_clock> end = std::chrono::steady_clock::now();
+	int ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+	fprintf(stderr, "3x3 batch solve: %d ms for %d solves\n", ms, (int)cubes.size());
+
+	EXPECT(solutions.size() == cubes.size(), "3x3 batch: Solution count matches", );
+	for (size_t i = 0; i < cubes.size(); i++)
+	{
+		if (solutions[i] != expected[i])
+		{
+			fprintf(stderr, "BATCH SOLUTION %d DOES NOT MATCH (expected %s, got %s)\n", (int)i,
+				expected[i].ToString().c_str(), solutions[i].ToString().c_str());
+			Cube3x3Faces(cubes[i]).PrintDebugState();
+			return 1;
+		}
+	}
+
+	// A time limit for each solve still gives every cube a solution, as limits only apply after
+	// the first solution is found
+	options.solveTimeLimit = std::chrono::milliseconds(1);
+	solutions = Cube3x3::SolveBatch(cubes, options);
+	Cube3x3 solved;
+	EXPECT_REPEAT((solved = cubes[_i], solved.Apply(solutions[_i]), solved.IsSolved()), (int)cubes.size(),
+		"3x3 batch: Solutions with a time limit for each solve are valid", );
+	return 0;
+}
+
+
+#ifdef TPSCUBE_COUNT_ALLOCATIONS
+int Cube3x3SolverAllocationTest()
+{
+	SimpleSeededRandomSource rng;
+	Cube3x3Solver solver;
+	CubeMoveSequence solution;
+	solution.moves.reserve(MAX_3X3_SOLUTION_MOVES);
+	for (size_t i = 0; i < 10; i++)
+	{
+		Cube3x3 cube;
+		cube.GenerateRandomState(rng);
+		CubeMoveSequence expected = cube.Solve();
+
+		size_t allocations = g_allocationCount.load();
+		solver.Solve(cube, solution);
+		allocations = g_allocationCount.load() - allocations;
+
+		EXPECT(solution == expected, "3x3 solver: Solution matches Solve", );
+		EXPECT(allocations == 0, "3x3 solver: Solve does not allocate",
+			fprintf(stderr, "%d allocations\n", (int)allocations));
+	}
+	return 0;
+}
+#endif
+
+
+int Cube3x3AnytimeSolveTest()
+{
+	SimpleSeededRandomSource rng;
+	for (size_t i = 0; i < 10; i++)
+	{
+		Cube3x3 cube;
+		cube.GenerateRandomState(rng);
+
+		// Even with a tiny node budget, a valid solution must be returned
+		vector<CubeMoveSequence> improvements;
+		Cube3x3SolveLimits limits;
+		limits.maxNodes = 1;
+		limits.improvedFunc = [&](const CubeMoveSequence& solution) { improvements.push_back(solution); };
+		CubeMoveSequence solution = cube.Solve(limits);
+
+		CubeMoveSequence optimal = cube.Solve();
+		fprintf(stderr, "3x3 anytime solve: %d moves with node limit, %d moves optimal\n",
+			(int)solution.moves.size(), (int)optimal.moves.size());
+
+		Cube3x3 solved = cube;
+		solved.Apply(solution);
+		if (!solved.IsSolved())
+		{
+			fprintf(stderr, "NOT SOLVED\n");
+			Cube3x3Faces(cube).PrintDebugState();
+			return 1;
+		}
+		if ((improvements.size() == 0) || (improvements.back() != solution))
+		{
+			fprintf(stderr, "IMPROVEMENT NOT REPORTED\n");
+			return 1;
+		}
+		for (size_t j = 1; j < improvements.size(); j++)
+		{
+			if (improvements[j].moves.size() >= improvements[j - 1].moves.size())
+			{
+				fprintf(stderr, "IMPROVEMENTS ARE NOT SHORTER\n");
+				return 1;
+			}
+		}
+
+		// If the limits are not reached, the result must match the unlimited search
+		improvements.clear();
+		limits.maxNodes = 0;
+		limits.deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+		solution = cube.Solve(limits);
+		if ((solution != optimal) || (improvements.back() != optimal))
+		{
+			fprintf(stderr, "ANYTIME SOLUTION DOES NOT MATCH (optimal %s)\n", optimal.ToString().c_str());
+			Cube3x3Faces(cube).PrintDebugState();
+			return 1;
+		}
+	}
+	return 0;
+}
+
+
+int Cube3x3CancelSolveTest()
+{
+	// A solve that is already cancelled must not return a solution
+	SimpleSeededRandomSource rng;
+	Cube3x3 cube;
+	cube.GenerateRandomState(rng);
+	CancellationToken cancel;
+	cancel.Cancel();
+	Cube3x3SolveLimits limits;
+	limits.cancel = &cancel;
+	EXPECT(cube.Solve(limits).moves.size() == 0, "3x3 cancel: Solve with cancelled token returns no solution", );
+
+	// Use a state that is close to solved, these take the longest to prove optimal
+	CubeMoveSequence moves = cube.Solve();
+	for (size_t i = 0; i < 7; i++)
+		cube.Move(moves.moves[i]);
+
+	// Cancel from another thread while the solve is running
+	cancel.Reset();
+	std::chrono::time_point<std::chrono::steady_clock> cancelTime;
+	thread cancelThread([&]() {
+		this_thread::sleep_for(std::chrono::milliseconds(10));
+		cancelTime = std::chrono::steady_clock::now();
+		cancel.Cancel();
+	});
+	CubeMoveSequence solution = cube.Solve(limits);
+	std::chrono::time_point<std::chrono::steady_clock> end = std::chrono::steady_clock::now();
+	cancelThread.join();
+	int us = (int)std::chrono::duration_cast<std::chrono::microseconds>(end - cancelTime).count();
+	fprintf(stderr, "3x3 cancel: solve stopped %d us after cancel\n", us);
+	EXPECT(solution.moves.size() == 0, "3x3 cancel: Solve cancelled from another thread returns no solution", );
+	return 0;
+}
+
+
+int Cube3x3SolutionCacheTest()
+{
+	SimpleSeededRandomSource rng;
+	vector<Cube3x3> cubes;
+	vector<CubeMoveSequence> expected;
+	for (size_t i = 0; i < 6; i++)
+	{
+		Cube3x3 cube;
+		cube.GenerateRandomState(rng);
+		cubes.push_back(cube);
+		expected.push_back(cube.Solve(false));
+	}
+
+	EXPECT(!(Cube3x3SolutionCache::GetKey(cubes[0], false) == Cube3x3SolutionCache::GetKey(cubes[0], true)),
+		"3x3 cache: Solve mode is part of the key", );
+	EXPECT(!(Cube3x3SolutionCache::GetKey(cubes[0], false) == Cube3x3SolutionCache::GetKey(cubes[1], false)),
+		"3x3 cache: Different states have different keys", );
+
+	// Solve every state twice with a cache that can hold all of them
+	Cube3x3SolutionCache cache(8);
+	Cube3x3::SetSolutionCache(&cache);
+	bool match = true;
+	for (size_t pass = 0; pass < 2; pass++)
+	{
+		for (size_t i = 0; i < cubes.size(); i++)
+			match = match && (cubes[i].Solve(false) == expected[i]);
+	}
+	EXPECT(match, "3x3 cache: Solutions match uncached solves", );
+	EXPECT((cache.GetMissCount() == 6) && (cache.GetHitCount() == 6), "3x3 cache: Second solves are hits",
+		fprintf(stderr, "%d hits, %d misses\n", (int)cache.GetHitCount(), (int)cache.GetMissCount()));
+
+	// A smaller cache must evict entries but still return correct solutions
+	Cube3x3SolutionCache smallCache(2);
+	Cube3x3::SetSolutionCache(&smallCache);
+	for (size_t pass = 0; pass < 2; pass++)
+	{
+		for (size_t i = 0; i < cubes.size(); i++)
+			match = match && (cubes[i].Solve(false) == expected[i]);
+	}
+	EXPECT(match, "3x3 cache: Solutions match after eviction", );
+	EXPECT(smallCache.GetMissCount() > 6, "3x3 cache: Entries are evicted when full", );
+	Cube3x3::SetSolutionCache(nullptr);
+	return 0;
+}
+
+
+// Scrambler that can never generate a scramble, like the random state scrambler without tables
+class FailingScrambler: public Scrambler
+{
+public:
+	virtual string GetName() override { return "Failing"; }
+	virtual CubeMoveSequence GetScramble(RandomSource&) override { return CubeMoveSequence(); }
+	virtual size_t GetMaxMoveCount() override { return 0; }
+};
+
+
+int ScramblePoolTest()
+{
+	const char* path = "tpscubetest.scrambles";
+	remove(path);
+	ScramblePool::SetFilePath(path);
+
+	// Reads the scrambles in the pool file
+	auto readFile = [&]() {
+		vector<CubeMoveSequence> result;
+		FILE* fp = fopen(path, "r");
+		if (!fp)
+			return result;
+		char line[1024];
+		while (fgets(line, sizeof(line), fp))
+		{
+			line[strcspn(line, "\r\n")] = 0;
+			CubeMoveSequence scramble;
+			const char* separator = strchr(line, '\t');
+			if (separator && CubeMoveSequence::FromString(separator + 1, scramble))
+				result.push_back(scramble);
+		}
+		fclose(fp);
+		return result;
+	};
+
+	shared_ptr<Scrambler> scrambler = make_shared<Cube3x3RandomStateScramble>();
+	ScramblePool pool(scrambler, make_shared<SimpleSeededRandomSource>(), 4);
+	pool.Start();
+	CubeMoveSequence scramble = pool.GetScramble();
+	Cube3x3 cube;
+	cube.Apply(scramble);
+	EXPECT((scramble.moves.size() != 0) && !cube.IsSolved(), "3x3 scramble pool: Scramble is generated", );
+
+	// Wait for the pool to refill, then stop it, which moves the ready scrambles to the file
+	while (pool.GetReadyCount() < 4)
+		this_thread::sleep_for(std::chrono::milliseconds(1));
+	pool.Stop();
+	vector<CubeMoveSequence> saved = readFile();
+	EXPECT((saved.size() == 4) && (pool.GetReadyCount() == 0),
+		"3x3 scramble pool: Stopping moves the ready scrambles to the file", );
+
+	// A new pool must have the saved scrambles available as soon as it starts
+	ScramblePool restarted(scrambler, make_shared<SimpleSeededRandomSource>(2), 4);
+	restarted.Start();
+	bool match = saved.size() == 4;
+	for (auto& i : saved)
+		match = match && restarted.TryGetScramble(scramble) && (scramble == i);
+	EXPECT(match, "3x3 scramble pool: Saved scrambles are ready immediately after start", );
+
+	// The file is only written again when the pool stops. If the app is killed before that, the
+	// loaded scrambles must not be in the file, or they would be used again on the next launch.
+	// This also keeps another pool for the same scrambler from using them.
+	ScramblePool afterKill(scrambler, make_shared<SimpleSeededRandomSource>(3), 4);
+	EXPECT(afterKill.Load(path) && (afterKill.GetReadyCount() == 0),
+		"3x3 scramble pool: Loaded scrambles are removed from the file", );
+
+	// Stopping saves the newly generated scrambles, and none of the used ones
+	while (restarted.GetReadyCount() < 4)
+		this_thread::sleep_for(std::chrono::milliseconds(1));
+	restarted.Stop();
+	ScramblePool next(scrambler, make_shared<SimpleSeededRandomSource>(4), 4);
+	bool replayed = false;
+	EXPECT(next.Load(path) && (next.GetReadyCount() == 4), "3x3 scramble pool: New scrambles are saved", );
+	while (next.TryGetScramble(scramble))
+		replayed = replayed || (find(saved.begin(), saved.end(), scramble) != saved.end());
+	EXPECT(!replayed, "3x3 scramble pool: Used scrambles are not saved again", );
+
+	// Restarting a stopped pool must not hand out the saved scrambles from memory while also
+	// keeping them in the file
+	ScramblePool cycled(scrambler, make_shared<SimpleSeededRandomSource>(5), 4);
+	cycled.Start();
+	while (cycled.GetReadyCount() < 4)
+		this_thread::sleep_for(std::chrono::milliseconds(1));
+	cycled.Stop();
+	size_t fileSize = readFile().size();
+	cycled.Start();
+	while (cycled.GetReadyCount() < 4)
+		this_thread::sleep_for(std::chrono::milliseconds(1));
+	cycled.Stop();
+	EXPECT((fileSize == 4) && (readFile().size() == fileSize),
+		"3x3 scramble pool: File does not grow when a pool is restarted", );
+
+	ScramblePool::SetFilePath("");
+	remove(path);
+
+	// Waiting on a scrambler that fails must return instead of blocking forever
+	ScramblePool failing(make_shared<FailingScrambler>(), make_shared<SimpleSeededRandomSource>(), 4);
+	failing.Start();
+	EXPECT(failing.GetScramble().moves.size() == 0, "3x3 scramble pool: Failed scrambler does not block", );
+	failing.Stop();
+	return 0;
+}
+
+
+int Cube3x3OptimalSolveTest()
+{
+	SimpleSeededRandomSource rng;
+	for (size_t i = 0; i < 10; i++)
+	{
+		// Random states take far too long to solve optimally, use short scrambles instead
+		Cube3x3 cube;
+		CubeMoveSequence scramble;
+		for (size_t j = 0; j < 12; j++)
+			scramble.moves.push_back(CubeMoveSequence::RandomMove(rng));
+		cube.Apply(scramble);
+
+		std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+		CubeMoveSequence solution = Cube3x3OptimalSolver::Solve(cube, 1);
+		std::chrono::time_point<std::chrono::steady_clock> end = std::chrono::steady_clock::now();
+		int ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+		fprintf(stderr, "3x3 optimal solve: %d ms for solution in %d moves (%s)\n", ms, (int)solution.moves.size(), solution.ToString().c_str());
+
+		Cube3x3 solved = cube;
+		solved.Apply(solution);
+		EXPECT(solved.IsSolved(), "3x3 optimal solve: Solution solves the cube", );
+		EXPECT(solution.moves.size() <= cube.Solve().moves.size(),
+			"3x3 optimal solve: Solution is no longer than the two phase solution", );
+		EXPECT(Cube3x3OptimalSolver::Solve(cube, 4) == solution,
+			"3x3 optimal solve: Parallel solution matches serial solution", );
+	}
+	return 0;
+}
+
+
 int RunTest()
 {
+	// Keep the solver tables between test runs
+	Cube3x3::SetTableFilePath("tpscube3x3.tables");
+	Cube3x3OptimalSolver::SetTableFilePath("tpscube3x3optimal.tables");
+
 	if (Cube3x3BasicMoveTest<Cube3x3Faces>("3x3"))
 		return 1;
+	if (Cube3x3FacesScalarTest())
+		return 1;
 	if (Cube3x3MatchTest())
 		return 1;
 	if (Cube3x3BasicMoveTest<Cube3x3>("3x3 pieces"))
 		return 1;
+	if (Cube3x3PackedTest())
+		return 1;
+	if (RandomSourceTest())
+		return 1;
 	if (Cube3x3IndexTest())
 		return 1;
 	if (Cube3x3SolveTest())
 		return 1;
+	if (Cube3x3RandomStateScrambleTest())
+		return 1;
 	if (Cube3x3IntermediateSolveTest())
 		return 1;
+	if (Cube3x3ParallelSolveTest())
+		return 1;
+	if (Cube3x3BatchSolveTest())
+		return 1;
+#ifdef TPSCUBE_COUNT_ALLOCATIONS
+	if (Cube3x3SolverAllocationTest())
+		return 1;
+#endif
+	if (Cube3x3AnytimeSolveTest())
+		return 1;
+	if (Cube3x3CancelSolveTest())
+		return 1;
+	if (Cube3x3SolutionCacheTest())
+		return 1;
+	if (ScramblePoolTest())
+		return 1;
+	if (Cube3x3OptimalSolveTest())
+		return 1;
 	return 0;
 }
 
@@ -309,10 +924,25 @@ int main(int argc, char* argv[])
 	History::instance.idGenerator = new QtIdGenerator();
 	BluetoothCubeType::Init();
 
+	// Cache solutions for states that are solved more than once, such as when a scramble is fixed
+	// after a mis-turn. The cache is used by solves on other threads, so it is never freed.
+	Cube3x3::SetSolutionCache(new Cube3x3SolutionCache());
+
 	QString dataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
 	bool aborted = false;
 	if (QDir().mkpath(dataPath))
 	{
+		// Start loading the solver tables while the solve history is loading. If there is no
+		// table file yet, this will generate it.
+		Cube3x3::SetTableFilePath(QDir(dataPath).filePath("tpscube3x3.tables").toStdString());
+		Cube3x3::PrepareTablesInBackground();
+
+		// The optimal solver tables are only generated when an optimal solve is first requested
+		Cube3x3OptimalSolver::SetTableFilePath(QDir(dataPath).filePath("tpscube3x3optimal.tables").toStdString());
+
+		// Scrambles that were generated ahead of time are kept between launches
+		ScramblePool::SetFilePath(QDir(dataPath).filePath("tpscube.scrambles").toStdString());
+
 		QProgressDialog progress("Loading solve history...", "Cancel", 0, 1);
 		progress.setWindowModality(Qt::ApplicationModal);
 		leveldb::Status status = History::instance.OpenDatabase(QDir(dataPath).filePath("tpscube.solvedata").toStdString(),
@@ -341,6 +971,7 @@ int main(int argc, char* argv[])
 	}
 	else
 	{
+		Cube3x3::PrepareTablesInBackground();
 		QMessageBox::critical(nullptr, "Error", "Local data storage location " + dataPath + " could not be written to. "
 			"Solve history will not be saved.");
 	}
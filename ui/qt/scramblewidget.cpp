@@ -3,6 +3,7 @@
 #include "theme.h"
 
 #define MOVES_PER_ROW 8
+#define RESCRAMBLE_TIME_LIMIT_MS 1000
 
 using namespace std;
 
@@ -13,6 +14,14 @@ int QtRandomSource::Next(int range)
 }
 
 
+void QtRandomSource::Fill(int range, int* out, size_t n)
+{
+	QRandomGenerator* rng = QRandomGenerator::global();
+	for (size_t i = 0; i < n; i++)
+		out[i] = rng->bounded(range);
+}
+
+
 RescrambleThread::RescrambleThread(QObject* owner): QThread(owner)
 {
 }
@@ -40,6 +49,7 @@ void RescrambleThread::run()
 		CubeMoveSequence scramble = m_inScramble;
 		Cube3x3 state = m_initialState;
 		m_requestPending = false;
+		m_cancel.Reset();
 
 		m_mutex.unlock();
 
@@ -50,7 +60,10 @@ void RescrambleThread::run()
 		state = Cube3x3();
 		state.Apply(inverted);
 		state.Apply(scramble);
-		CubeMoveSequence result = state.Solve().Inverted();
+		Cube3x3SolveLimits limits;
+		limits.deadline = chrono::steady_clock::now() + chrono::milliseconds(RESCRAMBLE_TIME_LIMIT_MS);
+		limits.cancel = &m_cancel;
+		CubeMoveSequence result = state.Solve(limits, 0).Inverted();
 
 		m_mutex.lock();
 		if (!m_requestPending)
@@ -66,6 +79,7 @@ void RescrambleThread::run()
 void RescrambleThread::stop()
 {
 	m_running = false;
+	m_cancel.Cancel();
 	m_cond.notify_all();
 }
 
@@ -76,6 +90,7 @@ void RescrambleThread::requestRescramble(const Cube3x3& state, const CubeMoveSeq
 	m_requestPending = true;
 	m_inScramble = scramble;
 	m_initialState = state;
+	m_cancel.Cancel();
 	m_cond.notify_one();
 }
 
@@ -85,6 +100,7 @@ void RescrambleThread::cancel()
 	QMutexLocker lock(&m_mutex);
 	m_requestPending = true;
 	m_inScramble.moves.clear();
+	m_cancel.Cancel();
 	m_cond.notify_one();
 }
 
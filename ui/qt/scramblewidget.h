@@ -13,6 +13,7 @@ class QtRandomSource: public RandomSource
 {
 public:
 	virtual int Next(int range) override;
+	virtual void Fill(int range, int* out, size_t n) override;
 };
 
 class RescrambleThread: public QThread
@@ -23,6 +24,7 @@ class RescrambleThread: public QThread
 	CubeMoveSequence m_inScramble;
 	Cube3x3 m_initialState;
 	CubeMoveSequence m_outScramble;
+	CancellationToken m_cancel;
 
 	QMutex m_mutex;
 	QWaitCondition m_cond;
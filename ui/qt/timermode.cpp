@@ -7,72 +7,6 @@
 using namespace std;
 
 
-ScrambleThread::ScrambleThread(QObject* owner): QThread(owner)
-{
-}
-
-
-void ScrambleThread::run()
-{
-	while (m_running)
-	{
-		m_mutex.lock();
-		if (m_running && !m_requestPending)
-			m_cond.wait(&m_mutex);
-	
-		if (!m_running)
-		{
-			m_mutex.unlock();
-			break;
-		}
-		if (!m_requestPending)
-		{
-			m_mutex.unlock();
-			continue;
-		}
-
-		shared_ptr<Scrambler> scrambler = m_scrambler;
-		m_requestPending = false;
-
-		m_mutex.unlock();
-
-		QtRandomSource rng;
-		CubeMoveSequence result = scrambler->GetScramble(rng);
-
-		m_mutex.lock();
-		if (!m_requestPending)
-		{
-			m_result = result;
-			emit scrambleGenerated();
-		}
-		m_mutex.unlock();
-	}
-}
-
-
-void ScrambleThread::stop()
-{
-	m_running = false;
-	m_cond.notify_all();
-}
-
-
-void ScrambleThread::requestScramble(const shared_ptr<Scrambler>& scrambler)
-{
-	QMutexLocker lock(&m_mutex);
-	m_requestPending = true;
-	m_scrambler = scrambler;
-	m_cond.notify_one();
-}
-
-
-CubeMoveSequence ScrambleThread::scramble()
-{
-	QMutexLocker lock(&m_mutex);
-	return m_result;
-}
-
-
 TimerMode::TimerMode(QWidget* parent): QWidget(parent)
 {
 	setBackgroundRole(QPalette::Base);
@@ -120,28 +54,30 @@ TimerMode::TimerMode(QWidget* parent): QWidget(parent)
 
 	updateFontSizes();
 
-	m_scrambleThread = new ScrambleThread(this);
-	connect(m_scrambleThread, &ScrambleThread::scrambleGenerated, this, &TimerMode::scrambleGenerated);
-	m_scrambleThread->start();
+	// Keep scrambles ready ahead of time so that the next solve can start immediately. The pool
+	// calls back from its own thread, so queue the update for the UI thread.
+	m_scramblePool = make_unique<ScramblePool>(m_scrambler, make_shared<QtRandomSource>());
+	m_scramblePool->SetReadyCallback([this]() {
+		QMetaObject::invokeMethod(this, "scrambleGenerated", Qt::QueuedConnection);
+	});
+	m_scramblePool->Start();
 	newScramble();
 }
 
 
 TimerMode::~TimerMode()
 {
-	m_scrambleThread->stop();
-	m_scrambleThread->wait();
+	// Saves the remaining scrambles for the next launch
+	m_scramblePool->Stop();
 }
 
 
 void TimerMode::newScramble()
 {
-	if (m_pendingScrambleValid)
+	if (m_scramblePool->TryGetScramble(m_currentScramble))
 	{
-		// There is an extra scramble already generated, use it now
+		// There is a scramble already generated, use it now
 		m_scrambleValid = true;
-		m_currentScramble = m_pendingScramble;
-		m_pendingScrambleValid = false;
 		m_scrambleWidget->setScramble(m_currentScramble);
 		m_timer->enable();
 	}
@@ -152,9 +88,6 @@ void TimerMode::newScramble()
 		m_scrambleWidget->invalidateScramble();
 		m_timer->disable();
 	}
-
-	// Generate a new scramble
-	m_scrambleThread->requestScramble(m_scrambler);
 }
 
 
@@ -286,23 +219,9 @@ void TimerMode::solveComplete()
 
 void TimerMode::scrambleGenerated()
 {
-	if (m_scrambleValid)
-	{
-		// There is already a scramble, save it for next time
-		m_pendingScrambleValid = true;
-		m_pendingScramble = m_scrambleThread->scramble();
-		return;
-	}
-
-	// Was waiting on a scramble, set it up
-	m_scrambleValid = true;
-	m_currentScramble = m_scrambleThread->scramble();
-	m_scrambleWidget->setScramble(m_currentScramble);
-	m_timer->enable();
-
-	// Generate an extra scramble in the background so that the
-	// next solve will be ready to start immediately
-	m_scrambleThread->requestScramble(m_scrambler);
+	// If there is already a scramble, the new one stays in the pool for next time
+	if (!m_scrambleValid)
+		newScramble();
 }
 
 
@@ -2,9 +2,6 @@
 
 #include <QtWidgets/QWidget>
 #include <QtWidgets/QVBoxLayout>
-#include <QtCore/QThread>
-#include <QtCore/QMutex>
-#include <QtCore/QWaitCondition>
 #include "sessionwidget.h"
 #include "scramblewidget.h"
 #include "timerwidget.h"
@@ -12,32 +9,7 @@
 #include "bluetoothcube.h"
 #include "cube3x3widget.h"
 #include "solvestatswidget.h"
-
-class ScrambleThread: public QThread
-{
-	Q_OBJECT
-
-	bool m_requestPending = false;
-	std::shared_ptr<Scrambler> m_scrambler;
-	CubeMoveSequence m_result;
-
-	QMutex m_mutex;
-	QWaitCondition m_cond;
-	volatile bool m_running = true;
-
-protected:
-	virtual void run() override;
-
-public:
-	ScrambleThread(QObject* owner);
-	void stop();
-
-	void requestScramble(const std::shared_ptr<Scrambler>& scrambler);
-	CubeMoveSequence scramble();
-
-signals:
-	void scrambleGenerated();
-};
+#include "scramblepool.h"
 
 class TimerMode: public QWidget
 {
@@ -53,11 +25,9 @@ class TimerMode: public QWidget
 
 	SolveType m_solveType = SOLVE_3X3X3;
 	std::shared_ptr<Scrambler> m_scrambler;
+	std::unique_ptr<ScramblePool> m_scramblePool;
 	bool m_scrambleValid = false;
 	CubeMoveSequence m_currentScramble;
-	bool m_pendingScrambleValid = false;
-	CubeMoveSequence m_pendingScramble;
-	ScrambleThread* m_scrambleThread;
 
 	std::shared_ptr<BluetoothCube> m_bluetoothCube;
 	Cube3x3Widget* m_cube3x3Widget;